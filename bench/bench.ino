@@ -0,0 +1,297 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*Benchmark regression routines for library code.
+ *
+ * Times the CRC and each message type's make/encode/decode path
+ * (including the aggregated, group and compact response frames),
+ * plus decoding of random garbage (the failure path a hub sees most),
+ * and compares each against a stored baseline for the reference board.
+ *
+ * Output is one machine-readable line per benchmark:
+ *     bench,<name>,<ns per frame>,<baseline ns>,<OK|SLOW|NEW>
+ * followed by a summary line, "%%% Benchmarks completed OK" or "***Bench FAILED***".
+ * A benchmark is SLOW (and the run fails) if more than threshold_percent above its baseline.
+ * A benchmark with no recorded baseline is NEW: it is reported, and counted in the summary,
+ * but only fails the run if BENCH_REQUIRE_BASELINES is defined,
+ * eg in CI once baselines have been recorded for the board it runs on.
+ *
+ * No baselines are recorded yet, so as shipped every benchmark is NEW and nothing can be SLOW.
+ * To record them, run on the reference board (V0p2 at 16MHz unless noted)
+ * and copy the measured ns values into the baselines below; 0 means not yet recorded.
+ * Timing is via micros(), so each benchmark runs enough iterations to swamp its 4us resolution.
+ */
+
+// Include libraries that this depends on.
+#include <OTV0p2Base.h>
+#include <OTRadioLink.h>
+
+// Include the library under test.
+#include <OTProtocolCC.h>
+
+
+void setup()
+  {
+#ifdef ON_V0P2_BOARD
+  // initialize serial communications at 4800 bps for typical use with V0p2 board.
+  Serial.begin(4800);
+#else
+  // initialize serial communications at 9600 bps for typical use with (eg) Arduino UNO.
+  Serial.begin(9600);
+#endif
+  }
+
+
+// Uncomment to fail the run if any benchmark has no baseline, once baselines are recorded.
+//#define BENCH_REQUIRE_BASELINES
+
+// Iterations per benchmark.
+static const uint16_t iterations = 1000;
+// Allowed slowdown against baseline before failing.
+static const uint8_t threshold_percent = 10;
+
+// Baselines in ns per frame on the reference board; 0 if not recorded.
+static const uint32_t baseline_crc = 0;
+static const uint32_t baseline_alert_encode = 0;
+static const uint32_t baseline_alert_decode = 0;
+static const uint32_t baseline_pac_encode = 0;
+static const uint32_t baseline_pac_decode = 0;
+static const uint32_t baseline_pr_encode = 0;
+static const uint32_t baseline_pr_decode = 0;
+static const uint32_t baseline_multi_encode = 0;
+static const uint32_t baseline_multi_decode = 0;
+static const uint32_t baseline_group_encode = 0;
+static const uint32_t baseline_group_decode = 0;
+static const uint32_t baseline_delta_encode = 0;
+static const uint32_t baseline_delta_decode = 0;
+static const uint32_t baseline_garbage_decode = 0;
+
+// Sink for results, so that the work is not optimised away.
+static volatile uint8_t sink;
+
+// Count of benchmarks slower than baseline allows.
+static uint8_t regressions;
+// Count of benchmarks with no baseline.
+static uint8_t missing;
+
+// Report one benchmark and check it against its baseline.
+static void report(const __FlashStringHelper *const name, const unsigned long elapsedUs, const uint32_t baseline)
+  {
+  const uint32_t ns = (uint32_t)((elapsedUs * 1000UL) / iterations);
+  Serial.print(F("bench,"));
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(ns);
+  Serial.print(',');
+  Serial.print(baseline);
+  Serial.print(',');
+  if(0 == baseline) { ++missing; Serial.println(F("NEW")); return; }
+  if(ns > baseline + (baseline * threshold_percent) / 100) { ++regressions; Serial.println(F("SLOW")); return; }
+  Serial.println(F("OK"));
+  }
+
+// CRC over a valid frame.
+static void benchCRC()
+  {
+  uint8_t buf[8];
+  OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false).encodeSimple(buf, sizeof(buf), true);
+  const unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    {
+    buf[5] = (uint8_t)i;
+    sink = OTProtocolCC::CC1Base::computeSimpleCRC(buf, sizeof(buf));
+    }
+  report(F("crc"), micros() - start, baseline_crc);
+  }
+
+// Make and encode then decode a CC1Alert.
+static void benchAlert()
+  {
+  uint8_t buf[8];
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    { sink = OTProtocolCC::CC1Alert::make(10, (uint8_t)i & 0x7f).encodeSimple(buf, sizeof(buf), true); }
+  report(F("alert_encode"), micros() - start, baseline_alert_encode);
+  OTProtocolCC::CC1Alert a;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = a.decodeSimple(buf, sizeof(buf)); }
+  report(F("alert_decode"), micros() - start, baseline_alert_decode);
+  }
+
+// Make and encode then decode a CC1PollAndCommand.
+static void benchPAC()
+  {
+  uint8_t buf[8];
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    { sink = OTProtocolCC::CC1PollAndCommand::make(10, 21, (uint8_t)i % 101, 2, 3, 1).encodeSimple(buf, sizeof(buf), true); }
+  report(F("pac_encode"), micros() - start, baseline_pac_encode);
+  OTProtocolCC::CC1PollAndCommand p;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = p.decodeSimple(buf, sizeof(buf)); }
+  report(F("pac_decode"), micros() - start, baseline_pac_decode);
+  }
+
+// Make and encode then decode a CC1PollResponse.
+static void benchPR()
+  {
+  uint8_t buf[8];
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    { sink = OTProtocolCC::CC1PollResponse::make(10, 21, 25, (uint8_t)i % 200, 80, 30, false, false, false).encodeSimple(buf, sizeof(buf), true); }
+  report(F("pr_encode"), micros() - start, baseline_pr_encode);
+  OTProtocolCC::CC1PollResponse r;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = r.decodeSimple(buf, sizeof(buf)); }
+  report(F("pr_decode"), micros() - start, baseline_pr_decode);
+  }
+
+// Make and encode then decode a CC1MultiPollAndCommand for 4 relays (so with the 16-bit CRC).
+static void benchMulti()
+  {
+  uint8_t buf[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1MultiPollAndCommand::max_frame_bytes>::total];
+  uint8_t len = 0;
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    {
+    OTProtocolCC::CC1MultiPollAndCommand m;
+    for(uint8_t r = 0; r < 4; ++r) { m.add(OTProtocolCC::CC1PollAndCommand::make(10, 21 + r, (uint8_t)i % 101, 2, 3, 1)); }
+    sink = len = m.encodeSimple(buf, sizeof(buf), true);
+    }
+  report(F("multi_encode"), micros() - start, baseline_multi_encode);
+  OTProtocolCC::CC1MultiPollAndCommand m;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = m.decodeSimple(buf, len); }
+  report(F("multi_decode"), micros() - start, baseline_multi_decode);
+  }
+
+// Make and encode then decode a CC1GroupCommand with members spanning 6 bitmap bytes (so with the 16-bit CRC).
+static void benchGroup()
+  {
+  uint8_t buf[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1GroupCommand::max_frame_bytes>::total];
+  uint8_t len = 0;
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    {
+    OTProtocolCC::CC1GroupCommand g = OTProtocolCC::CC1GroupCommand::make(7, (uint8_t)i % 101, 2, 3, 1);
+    g.addMember(3);
+    g.addMember(40);
+    sink = len = g.encodeSimple(buf, sizeof(buf), true);
+    }
+  report(F("group_encode"), micros() - start, baseline_group_encode);
+  OTProtocolCC::CC1GroupCommand g;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = g.decodeSimple(buf, len); }
+  report(F("group_decode"), micros() - start, baseline_group_decode);
+  }
+
+// Encode then decode a CC1PollResponseDelta with one changed byte against a base.
+static void benchDelta()
+  {
+  const OTProtocolCC::CC1PollResponse base = OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false);
+  uint8_t buf[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1PollResponseDelta::max_frame_bytes>::total];
+  uint8_t len = 0;
+  unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    {
+    const OTProtocolCC::CC1PollResponse current = OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, (uint8_t)i % 200, 30, false, false, false);
+    sink = len = OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, current, buf, sizeof(buf), true);
+    }
+  report(F("delta_encode"), micros() - start, baseline_delta_encode);
+  OTProtocolCC::CC1PollResponse out;
+  start = micros();
+  for(uint16_t i = 0; i < iterations; ++i) { sink = OTProtocolCC::CC1PollResponseDelta::decodeSimple(buf, len, base, out); }
+  report(F("delta_decode"), micros() - start, baseline_delta_decode);
+  }
+
+// Decode random garbage with each decoder in turn (types are kept plausible so that field checks and the CRC are exercised).
+static void benchGarbage()
+  {
+  static const uint8_t types[3] = { '!', '?', '*' };
+  static uint8_t frames[8][8];
+  for(uint8_t f = 0; f < 8; ++f)
+    {
+    for(uint8_t j = 0; j < 8; ++j) { frames[f][j] = OTV0P2BASE::randRNG8(); }
+    frames[f][0] = types[f % 3];
+    }
+  OTProtocolCC::CC1Alert a;
+  OTProtocolCC::CC1PollAndCommand p;
+  OTProtocolCC::CC1PollResponse r;
+  OTProtocolCC::CC1Base *const decoders[3] = { &a, &p, &r };
+  const unsigned long start = micros();
+  for(uint16_t i = 0; i < iterations; ++i)
+    {
+    const uint8_t f = (uint8_t)i & 7;
+    sink = decoders[f % 3]->decodeSimple(frames[f], 8);
+    }
+  report(F("garbage_decode"), micros() - start, baseline_garbage_decode);
+  }
+
+
+// To be called from loop() instead of main code when running benchmarks.
+// Each round runs every benchmark once.
+void loop()
+  {
+  static int loopCount = 0;
+
+  // Allow the terminal console to be brought up.
+  for(int i = 3; i > 0; --i)
+    {
+    Serial.print(F("Benchmarks starting... "));
+    Serial.print(i);
+    Serial.println();
+    delay(1000);
+    }
+  Serial.println();
+
+  regressions = 0;
+  missing = 0;
+  benchCRC();
+  benchAlert();
+  benchPAC();
+  benchPR();
+  benchMulti();
+  benchGroup();
+  benchDelta();
+  benchGarbage();
+
+#ifdef BENCH_REQUIRE_BASELINES
+  const bool failed = (0 != regressions) || (0 != missing);
+#else
+  const bool failed = (0 != regressions);
+#endif
+  // Announce successful or failed run.
+  if(!failed)
+    {
+    Serial.print(F("%%% Benchmarks completed OK, round "));
+    Serial.print(++loopCount);
+    if(0 != missing) { Serial.print(F(", missing baselines=")); Serial.print(missing); }
+    Serial.println();
+    }
+  else
+    {
+    Serial.print(F("***Bench FAILED*** regressions="));
+    Serial.print(regressions);
+    Serial.print(F(" missing baselines="));
+    Serial.print(missing);
+    Serial.println();
+    }
+  Serial.println();
+  Serial.println();
+  delay(2000);
+  }
@@ -26,6 +26,26 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015
 
 // Core support.
 #include "utility/OTProtocolCC_OTProtocolCC.h"
+#include "utility/OTProtocolCC_Units.h"
+#include "utility/OTProtocolCC_Trace.h"
+#include "utility/OTProtocolCC_Latency.h"
+
+// Hub/relay support.
+#include "utility/OTProtocolCC_HouseCodeMap.h"
+#include "utility/OTProtocolCC_ReplayProtection.h"
+#include "utility/OTProtocolCC_PollResponseRegistry.h"
+#include "utility/OTProtocolCC_LinkStats.h"
+#include "utility/OTProtocolCC_CommandDiffer.h"
+#include "utility/OTProtocolCC_PollInterval.h"
+#include "utility/OTProtocolCC_Snapshot.h"
+#include "utility/OTProtocolCC_RelayRx.h"
+#include "utility/OTProtocolCC_RelayTxScheduler.h"
+#include "utility/OTProtocolCC_Airtime.h"
+#include "utility/OTProtocolCC_MessagePool.h"
+#include "utility/OTProtocolCC_EncodedFrame.h"
+#include "utility/OTProtocolCC_MessageTemplate.h"
+#include "utility/OTProtocolCC_DecodeCache.h"
+#include "utility/OTProtocolCC_Metrics.h"
 
 
 #endif
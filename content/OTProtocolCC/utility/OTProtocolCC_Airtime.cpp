@@ -0,0 +1,79 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+#include "OTProtocolCC_Airtime.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+// Create accountant for the given limit and burst size, and framing overhead.
+CC1AirtimeAccountant::CC1AirtimeAccountant(uint16_t dutyPermille, uint32_t _burstUs,
+                                           const uint8_t _overheadBytes, const uint8_t _rawBitsPerByte)
+  : overheadBytes(_overheadBytes), rawBitsPerByte(_rawBitsPerByte), lastMs(0), totalUs(0), denied(0)
+    {
+    if(0 == dutyPermille) { dutyPermille = 1; }
+    if(dutyPermille > 1000) { dutyPermille = 1000; }
+    // Budget per hour in us is dutyPermille/1000 of 3600s.
+    const uint32_t budgetUs = (uint32_t)dutyPermille * 3600000UL;
+    if(_burstUs > budgetUs / 2) { _burstUs = budgetUs / 2; }
+    if(0 == _burstUs) { _burstUs = 1; }
+    burstUs = _burstUs;
+    rateUsPerS = (budgetUs - burstUs) / 3600;
+    fillS = (burstUs / rateUsPerS) + 1;
+    tokensUs = burstUs;
+    }
+
+// Add airtime accrued since the last refill, up to the burst size.
+// Fractions of a us are dropped, so the bucket never refills faster than the limit allows.
+void CC1AirtimeAccountant::refill(const uint32_t nowMs)
+    {
+    const uint32_t dt = nowMs - lastMs;
+    lastMs = nowMs;
+    const uint32_t s = dt / 1000;
+    if(s >= fillS) { tokensUs = burstUs; return; }
+    const uint32_t added = (s * rateUsPerS) + (((dt % 1000) * rateUsPerS) / 1000);
+    tokensUs = (added >= burstUs - tokensUs) ? burstUs : (tokensUs + added);
+    }
+
+// Charge the airtime of a frame about to be sent.
+// Returns true if the frame may be sent (and has been charged).
+bool CC1AirtimeAccountant::tryCharge(const uint32_t nowMs, const uint8_t frameBytes)
+    {
+    refill(nowMs);
+    const uint32_t cost = airtimeUs(frameBytes);
+    if(cost > tokensUs) { if(0xffff != denied) { ++denied; } return(false); } // FAIL.
+    tokensUs -= cost;
+    totalUs = (totalUs > 0xffffffffUL - cost) ? 0xffffffffUL : (totalUs + cost);
+    return(true);
+    }
+
+// Get the ms to wait until a frame could be sent; 0 if it can be now.
+uint32_t CC1AirtimeAccountant::msUntilAvailable(const uint32_t nowMs, const uint8_t frameBytes)
+    {
+    refill(nowMs);
+    const uint32_t cost = airtimeUs(frameBytes);
+    if(cost <= tokensUs) { return(0); }
+    // A frame longer than a full bucket can never be sent.
+    if(cost > burstUs) { return(0xffffffffUL); }
+    // Round up, allowing for the dropped fractions; split to avoid overflow.
+    const uint32_t need = cost - tokensUs;
+    return(((need / rateUsPerS) * 1000) + ((((need % rateUsPerS) * 1000) + rateUsPerS - 1) / rateUsPerS) + 1);
+    }
+
+    }
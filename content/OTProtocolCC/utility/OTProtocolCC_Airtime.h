@@ -0,0 +1,107 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Transmit airtime accounting against a regulatory duty-cycle limit.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_AIRTIME_H
+#define ARDUINO_LIB_OTPROTOCOLCC_AIRTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1AirtimeAccountant
+    // Token bucket of transmit airtime (in microseconds) for a hub (or relay),
+    // to keep its transmissions within a sub-band duty-cycle limit such as 1% (36s per hour) at 868MHz.
+    // Every frame is charged its on-air time before being sent, and is held back if the bucket is short.
+    // The bucket holds at most burstUs and refills continuously at the rate that,
+    // together with one full burst, exactly uses the hourly budget:
+    //     rate = (dutyPermille * 3.6s - burstUs) per hour
+    // so airtime in ANY one-hour window (not just aligned ones) never exceeds the limit,
+    // however bursty the demand, while sustained demand can run at close to the limit.
+    // Starts full.
+    // On-air time is from the FS20 carrier at 5kbps raw (200us per raw bit):
+    //     (overheadBytes * 8 + frameBytes * rawBitsPerByte) * 200us
+    // where overheadBytes covers the preamble and sync word (eg 5 + 3 for the RFM23B),
+    // and rawBitsPerByte is 8 for CC1 frames sent unencoded on the carrier.
+    // Times are in ms from any free-running clock (eg millis()), and may wrap.
+    class CC1AirtimeAccountant
+        {
+        public:
+            static const uint16_t raw_bit_us = 200;
+            static const uint8_t default_overhead_bytes = 8;
+            static const uint8_t default_raw_bits_per_byte = 8;
+            // Limit of 1%.
+            static const uint16_t default_duty_permille = 10;
+            // Default burst of a tenth of the hourly budget at 1%, about 140 8-byte frames.
+            static const uint32_t default_burst_us = 3600000UL;
+        private:
+            // Refill rate in us per second, and bucket size.
+            uint32_t rateUsPerS;
+            uint32_t burstUs;
+            // Whole seconds after which an empty bucket is certainly full.
+            uint32_t fillS;
+            uint8_t overheadBytes;
+            uint8_t rawBitsPerByte;
+            // Airtime available, and when last refilled.
+            uint32_t tokensUs;
+            uint32_t lastMs;
+            // Total airtime charged, saturating.
+            uint32_t totalUs;
+            // Frames held back for lack of airtime, saturating.
+            uint16_t denied;
+            void refill(uint32_t nowMs);
+        public:
+            // Create accountant for the given limit (in [1,1000] parts per thousand) and burst size,
+            // and framing overhead; out-of-range values are clamped.
+            // The burst is limited to half the hourly budget so that some continuous rate remains.
+            CC1AirtimeAccountant(uint16_t dutyPermille = default_duty_permille,
+                                 uint32_t burstUs = default_burst_us,
+                                 uint8_t overheadBytes = default_overhead_bytes,
+                                 uint8_t rawBitsPerByte = default_raw_bits_per_byte);
+
+            // Get the on-air time in us of a frame of frameBytes (as returned by encodeSimple()) including overhead.
+            uint32_t airtimeUs(const uint8_t frameBytes) const
+                { return(((uint32_t)overheadBytes * 8 + (uint32_t)frameBytes * rawBitsPerByte) * raw_bit_us); }
+
+            // Charge the airtime of a frame of frameBytes about to be sent at nowMs.
+            // Returns true if the frame may be sent (and has been charged),
+            // else false, in which case nothing is charged and the frame should be held back.
+            bool tryCharge(uint32_t nowMs, uint8_t frameBytes);
+
+            // Get the airtime in us available now, ie how much could be sent at once.
+            uint32_t getHeadroomUs(uint32_t nowMs) { refill(nowMs); return(tokensUs); }
+            // Get the ms to wait from nowMs until a frame of frameBytes could be sent; 0 if it can be now.
+            uint32_t msUntilAvailable(uint32_t nowMs, uint8_t frameBytes);
+
+            // Counters.
+            uint32_t getTotalUs() const { return(totalUs); }
+            uint16_t getDenied() const { return(denied); }
+            uint32_t getBurstUs() const { return(burstUs); }
+            uint32_t getRateUsPerS() const { return(rateUsPerS); }
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,155 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Hub-side suppression of poll/commands that would not change anything at the relay.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_COMMANDDIFFER_H
+#define ARDUINO_LIB_OTPROTOCOLCC_COMMANDDIFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_HouseCodeMap.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Command state for one relay, with commands packed as their two wire bytes (1+rp lf|lt|lc).
+    // A zero first byte marks no command, since that is never valid on the wire.
+    // Times first so that there is no padding between members:
+    // 13 bytes on AVR, 16 where uint32_t is 4-byte aligned (eg ARM and most hosts).
+    struct CC1CommandRecord
+        {
+        // When the last command was acknowledged, and when the last command was sent.
+        uint32_t ackedAt;
+        uint32_t sentAt;
+        // Last command acknowledged (by a poll response).
+        uint8_t acked[2];
+        // Last command sent and not yet acknowledged.
+        uint8_t sent[2];
+        // Times the outstanding command has been resent without acknowledgement, for backoff.
+        uint8_t retries;
+        CC1CommandRecord() : ackedAt(0), sentAt(0), retries(0) { acked[0] = 0; acked[1] = 0; sent[0] = 0; sent[1] = 0; }
+        };
+
+    // CC1CommandDiffer
+    // Hub-side record of the last command acknowledged by each of up to N relays,
+    // to decide whether a poll/command actually needs to go on air:
+    // only if the command differs from what the relay has acknowledged,
+    // or the keepalive is due (a relay may fall back to local control after ~30 minutes without one).
+    // A command sent but not yet acknowledged is not resent until the response window has passed,
+    // and that wait doubles with each unacknowledged resend up to the keepalive,
+    // so that a relay that is off or out of range is not polled every response window forever.
+    // Times are in ms from any free-running clock (eg millis()), and may wrap.
+    template<uint16_t N>
+    class CC1CommandDiffer
+        {
+        public:
+            // Default longest interval between polls of a relay.
+            static const uint32_t default_keepalive_ms = 15UL * 60UL * 1000UL;
+            // Time allowed for a poll response before a command is considered lost.
+            static const uint32_t response_window_ms = 10000UL;
+            // Cap on the backoff shift, well before response_window_ms << retries would overflow.
+            static const uint8_t max_backoff_shift = 15;
+        private:
+            CC1HouseCodeMap<CC1CommandRecord, N> records;
+            static inline bool same(const uint8_t *const a, const uint8_t *const b) { return((a[0] == b[0]) && (a[1] == b[1])); }
+            static inline bool elapsed(const uint32_t now, const uint32_t since, const uint32_t interval) { return((now - since) >= interval); }
+        public:
+            // Wait before resending an unacknowledged command already resent the given number of times:
+            // response_window_ms doubled per retry, but no more than keepaliveMs.
+            static uint32_t retryWaitMs(const uint8_t retries, const uint32_t keepaliveMs = default_keepalive_ms)
+                {
+                const uint32_t w = response_window_ms << ((retries > max_backoff_shift) ? max_backoff_shift : retries);
+                return((w > keepaliveMs) ? keepaliveMs : w);
+                }
+            // True if cmd should be transmitted at nowMs:
+            // the relay is not known to hold this command,
+            // or keepaliveMs has passed since it last acknowledged one.
+            // An invalid command never needs transmission.
+            bool needsTransmission(const CC1PollAndCommand &cmd, const uint32_t nowMs,
+                                   const uint32_t keepaliveMs = default_keepalive_ms) const
+                {
+                if(!cmd.isValid()) { return(false); }
+                const CC1CommandRecord *const r = records.find(cmd.getHC1(), cmd.getHC2());
+                if(NULL == r) { return(true); }
+                uint8_t c[2];
+                cmd.getCommandBytes(c);
+                // Awaiting the response to this very command.
+                if((0 != r->sent[0]) && same(c, r->sent) &&
+                   !elapsed(nowMs, r->sentAt, retryWaitMs(r->retries, keepaliveMs))) { return(false); }
+                if((0 == r->acked[0]) || !same(c, r->acked)) { return(true); }
+                return(elapsed(nowMs, r->ackedAt, keepaliveMs));
+                }
+            // Record that cmd was transmitted at nowMs.
+            // Resending the command still awaiting acknowledgement counts as a retry, for backoff.
+            // Returns false if the registry is full or the command invalid.
+            bool onSent(const CC1PollAndCommand &cmd, const uint32_t nowMs)
+                {
+                if(!cmd.isValid()) { return(false); } // FAIL.
+                CC1CommandRecord *const r = records.findOrInsert(cmd.getHC1(), cmd.getHC2());
+                if(NULL == r) { return(false); } // FAIL.
+                uint8_t c[2];
+                cmd.getCommandBytes(c);
+                if((0 != r->sent[0]) && same(c, r->sent)) { if(r->retries < 0xff) { ++r->retries; } }
+                else { r->sent[0] = c[0]; r->sent[1] = c[1]; r->retries = 0; }
+                r->sentAt = nowMs;
+                return(true);
+                }
+            // Record that the relay answered (eg with a poll response) at nowMs,
+            // acknowledging the last command sent to it.
+            // Returns false if nothing was awaiting acknowledgement.
+            bool onAcknowledged(const uint8_t hc1, const uint8_t hc2, const uint32_t nowMs)
+                {
+                CC1CommandRecord *const r = records.find(hc1, hc2);
+                if((NULL == r) || (0 == r->sent[0])) { return(false); } // FAIL.
+                r->acked[0] = r->sent[0];
+                r->acked[1] = r->sent[1];
+                r->ackedAt = nowMs;
+                r->sent[0] = 0;
+                r->retries = 0;
+                return(true);
+                }
+            // Iterate over relays (eg to snapshot them): for i in [0,capacity), get the record if any.
+            bool getRecord(const uint16_t i, uint8_t &hc1, uint8_t &hc2, const CC1CommandRecord *&r) const
+                { return(records.getSlot(i, hc1, hc2, r)); }
+            // Restore a relay's record (eg from a snapshot), with times already on this clock.
+            // Returns false if the house code is invalid or the registry is full.
+            bool restore(const uint8_t hc1, const uint8_t hc2, const CC1CommandRecord &r)
+                {
+                CC1CommandRecord *const p = records.findOrInsert(hc1, hc2);
+                if(NULL == p) { return(false); } // FAIL.
+                *p = r;
+                return(true);
+                }
+            // Maximum number of relays.
+            static const uint16_t capacity = N;
+            // Number of relays tracked.
+            uint16_t size() const { return(records.size()); }
+            // Forget all relays, so every command is next sent.
+            void clear() { records.clear(); }
+        };
+
+    }
+
+
+#endif
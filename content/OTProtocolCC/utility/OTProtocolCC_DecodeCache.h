@@ -0,0 +1,96 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Small cache of decoded fixed-length CC1 frames, so exact repeats skip CRC and validation.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_DECODECACHE_H
+#define ARDUINO_LIB_OTPROTOCOLCC_DECODECACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1DecodeCache
+    // Direct-mapped cache of N decoded instances of fixed-length CC1 message class T
+    // (eg CC1PollResponse or CC1Alert), keyed by the whole raw frame including CRC.
+    // Relays often resend byte-identical frames, and decoding is a pure function of the frame bytes,
+    // so on a hit the previous result is copied out without CRC or field validation.
+    // The slot is chosen from the CRC byte, which is already well mixed.
+    // Only successful decodes to valid instances are cached, so a corrupted frame is always fully checked
+    // and never matches a cached one (all 8 bytes are compared).
+    // Trace and latency hooks within T::decodeSimple() are not run on a hit.
+    // Costs N * (sizeof(T) + 8) + 4 bytes; N is in [1,128] and best a power of 2.
+    template<class T, uint8_t N>
+    class CC1DecodeCache
+        {
+        public:
+            static const uint8_t frame_bytes = CC1FrameBytes<T::primary_frame_bytes>::total;
+        private:
+            // Raw frame for each slot; a leading 0 (never a valid frame type) marks an empty slot.
+            uint8_t keys[N][frame_bytes];
+            T values[N];
+            // Hit and miss counts, saturating.
+            uint16_t hits, misses;
+            static inline void inc(uint16_t &c) { if(0xffff != c) { ++c; } }
+        public:
+            CC1DecodeCache() { clear(); }
+
+            // Empty the cache and reset counters.
+            void clear()
+                {
+                for(uint8_t i = 0; i < N; ++i) { keys[i][0] = 0; }
+                hits = 0;
+                misses = 0;
+                }
+
+            // Decode from the wire into out, as out.decodeSimple(buf, buflen) would.
+            // Returns number of bytes read, 0 if unsuccessful; also check out.isValid().
+            uint8_t decode(T &out, const uint8_t *const buf, const uint8_t buflen)
+                {
+                if((NULL == buf) || (buflen < frame_bytes)) { return(out.decodeSimple(buf, buflen)); }
+                const uint8_t slot = buf[frame_bytes - 1] % N;
+                uint8_t *const key = keys[slot];
+                bool match = (0 != key[0]);
+                for(uint8_t i = 0; match && (i < frame_bytes); ++i) { match = (key[i] == buf[i]); }
+                if(match) { inc(hits); out = values[slot]; return(frame_bytes); }
+                inc(misses);
+                const uint8_t n = out.decodeSimple(buf, buflen);
+                if((0 != n) && out.isValid())
+                    {
+                    values[slot] = out;
+                    for(uint8_t i = 0; i < frame_bytes; ++i) { key[i] = buf[i]; }
+                    }
+                return(n);
+                }
+
+            // Counters, saturating at 0xffff.
+            uint16_t getHits() const { return(hits); }
+            uint16_t getMisses() const { return(misses); }
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,132 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+#include "OTProtocolCC_EncodedFrame.h"
+
+#include <OTRadioLink.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+// Encode a fixed-length message and compute its raw CRC from scratch.
+bool CC1EncodedFrame::set(const CC1Base &m)
+    {
+    forceInvalid();
+    if(!m.isValid()) { return(false); } // FAIL.
+    uint8_t tmp[frame_bytes];
+    if(frame_bytes != m.encodeSimple(tmp, sizeof(tmp), true)) { return(false); } // FAIL.
+    uint8_t crc = tmp[0];
+    for(uint8_t i = 1; i < frame_bytes - 1; ++i)
+        { crc = CC1Base::crc7Update(crc, tmp[i]); }
+    rawCRC = crc;
+    for(uint8_t i = 1; i < frame_bytes; ++i) { buf[i] = tmp[i]; }
+    // Set type last so that the instance only becomes valid when complete.
+    buf[0] = tmp[0];
+    return(true);
+    }
+
+// Replace byte i in [1,6] with v, updating the CRC incrementally.
+// The CRC is linear, so the change is the CRC of the difference shifted through the remaining bytes.
+void CC1EncodedFrame::patchByte(const uint8_t i, const uint8_t v)
+    {
+    const uint8_t d = buf[i] ^ v;
+    if(0 == d) { return; }
+    buf[i] = v;
+    uint8_t c = CC1Base::crc7Update(0, d);
+    for(uint8_t j = i + 1; j < frame_bytes - 1; ++j)
+        { c = CC1Base::crc7Update(c, 0); }
+    rawCRC ^= c;
+    buf[frame_bytes - 1] = (0 != rawCRC) ? rawCRC : OTRadioLink::crc7_5B_update_nz_ALT;
+    }
+
+// CC1Alert and CC1PollAndCommand: sequence number, or CC1Base::no_seq.
+bool CC1EncodedFrame::setSeq(const uint8_t seq)
+    {
+    if((CC1Base::no_seq != seq) && (seq > CC1Base::seq_mask)) { return(false); } // FAIL.
+    const uint8_t b = (CC1Base::no_seq == seq) ? 1 : (seq + 2);
+    if(isType(CC1Alert::frame_type)) { patchByte(4, b); return(true); }
+    if(isType(CC1PollAndCommand::frame_type)) { patchByte(6, b); return(true); }
+    return(false); // FAIL.
+    }
+
+// CC1PollAndCommand: radiator valve percent open [0,100].
+bool CC1EncodedFrame::setRP(const uint8_t rp)
+    {
+    if(!isType(CC1PollAndCommand::frame_type) || (rp > 100)) { return(false); } // FAIL.
+    patchByte(3, rp + 1);
+    return(true);
+    }
+
+// CC1PollResponse: relative humidity [0,50] in 2% steps.
+bool CC1EncodedFrame::setRH(const uint8_t rh)
+    {
+    if(!isType(CC1PollResponse::frame_type) || (rh > 50)) { return(false); } // FAIL.
+    patchByte(3, (buf[3] & 0xc0) | (rh + 1));
+    return(true);
+    }
+
+// CC1PollResponse: pipe temperature [0,199] in 1/2 C steps.
+bool CC1EncodedFrame::setTP(const uint8_t tp)
+    {
+    if(!isType(CC1PollResponse::frame_type) || (tp > 199)) { return(false); } // FAIL.
+    patchByte(4, tp + 1);
+    return(true);
+    }
+
+// CC1PollResponse: room temperature [0,199] in 1/4 C steps.
+bool CC1EncodedFrame::setTR(const uint8_t tr)
+    {
+    if(!isType(CC1PollResponse::frame_type) || (tr > 199)) { return(false); } // FAIL.
+    patchByte(5, tr + 1);
+    return(true);
+    }
+
+// CC1PollResponse: ambient light [1,62].
+bool CC1EncodedFrame::setAL(const uint8_t al)
+    {
+    if(!isType(CC1PollResponse::frame_type) || (0 == al) || (al > 62)) { return(false); } // FAIL.
+    patchByte(6, (buf[6] & 0x80) | (al << 1));
+    return(true);
+    }
+
+// CC1PollResponse: window flag.
+bool CC1EncodedFrame::setW(const bool w)
+    {
+    if(!isType(CC1PollResponse::frame_type)) { return(false); } // FAIL.
+    patchByte(3, w ? (buf[3] | 0x80) : (buf[3] & 0x7f));
+    return(true);
+    }
+
+// CC1PollResponse: switch flag.
+bool CC1EncodedFrame::setS(const bool s)
+    {
+    if(!isType(CC1PollResponse::frame_type)) { return(false); } // FAIL.
+    patchByte(3, s ? (buf[3] | 0x40) : (buf[3] & 0xbf));
+    return(true);
+    }
+
+// CC1PollResponse: syncing flag.
+bool CC1EncodedFrame::setSY(const bool sy)
+    {
+    if(!isType(CC1PollResponse::frame_type)) { return(false); } // FAIL.
+    patchByte(6, sy ? (buf[6] | 0x80) : (buf[6] & 0x7f));
+    return(true);
+    }
+
+    }
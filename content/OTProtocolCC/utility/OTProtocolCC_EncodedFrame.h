@@ -0,0 +1,105 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Pre-encoded CC1 frames whose fields can be patched in place without a full re-encode.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_ENCODEDFRAME_H
+#define ARDUINO_LIB_OTPROTOCOLCC_ENCODEDFRAME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1EncodedFrame
+    // The 8 wire bytes (including CRC) of a fixed-length CC1 message,
+    // for a sender that transmits nearly the same frame repeatedly,
+    // eg a relay answering each poll with a CC1PollResponse in which only tr or tp moves.
+    // Field setters validate the new value, rewrite only the affected byte,
+    // and fold the change into the CRC using its linearity:
+    // a change d to byte i alters the raw CRC by CC1Base::crc7Update(0, d) followed by (6-i) zero-byte updates,
+    // so the later the byte the cheaper the patch, and no other byte is read.
+    // The raw (possibly zero) CRC is kept alongside the wire bytes
+    // since the wire form replaces a zero CRC with a non-zero value.
+    // The bytes are always a valid frame that decodeSimple() would accept, or the instance is invalid.
+    class CC1EncodedFrame
+        {
+        public:
+            // Wire bytes including the trailing CRC.
+            static const uint8_t frame_bytes = 8;
+        private:
+            uint8_t buf[frame_bytes];
+            // CRC before replacement of zero by a non-zero value.
+            uint8_t rawCRC;
+            // Replace byte i in [1,6] with v, updating the CRC incrementally.
+            void patchByte(uint8_t i, uint8_t v);
+            // True if valid and of the given frame type.
+            bool isType(const uint8_t t) const { return(t == buf[0]); }
+        public:
+            // Create invalid (empty) instance.
+            CC1EncodedFrame() { forceInvalid(); }
+            void forceInvalid() { buf[0] = 0; }
+            // True if this holds a frame.
+            bool isValid() const { return(0 != buf[0]); }
+
+            // Encode a CC1Alert, CC1PollAndCommand or CC1PollResponse with full CRC computation.
+            // Returns false and leaves this invalid if the message is invalid or not of a fixed 7+1 byte type.
+            bool set(const CC1Alert &m) { return(set((const CC1Base &)m)); }
+            bool set(const CC1PollAndCommand &m) { return(set((const CC1Base &)m)); }
+            bool set(const CC1PollResponse &m) { return(set((const CC1Base &)m)); }
+
+            // Get the wire bytes (frame_bytes long) for transmission; NULL if invalid.
+            const uint8_t *getBytes() const { return(isValid() ? buf : NULL); }
+            // Get the wire length, or 0 if invalid.
+            uint8_t getLength() const { return(isValid() ? frame_bytes : 0); }
+
+            // Setters for single fields, with the same ranges as the make() factories.
+            // Each returns false, leaving the frame unchanged, if the value is out of range
+            // or the frame is not of the type that has that field.
+
+            // CC1Alert and CC1PollAndCommand: sequence number, or CC1Base::no_seq.
+            bool setSeq(uint8_t seq);
+            // CC1PollAndCommand: radiator valve percent open [0,100].
+            bool setRP(uint8_t rp);
+            // CC1PollResponse: relative humidity [0,50] in 2% steps.
+            bool setRH(uint8_t rh);
+            // CC1PollResponse: pipe temperature [0,199] in 1/2 C steps.
+            bool setTP(uint8_t tp);
+            // CC1PollResponse: room temperature [0,199] in 1/4 C steps.
+            bool setTR(uint8_t tr);
+            // CC1PollResponse: ambient light [1,62].
+            bool setAL(uint8_t al);
+            // CC1PollResponse: window, switch and syncing flags.
+            bool setW(bool w);
+            bool setS(bool s);
+            bool setSY(bool sy);
+
+        private:
+            bool set(const CC1Base &m);
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,142 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Fixed-capacity per-relay registry keyed by CC1 house code, for hub-side state.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_HOUSECODEMAP_H
+#define ARDUINO_LIB_OTPROTOCOLCC_HOUSECODEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Fixed-capacity open-addressed map from house code (hc1, hc2) to a value V.
+    // No heap is used; all storage is inline so the map can be static.
+    // Keys are held in a separate array from the values so that a probe sequence
+    // only touches the (2-byte) keys until the match is found.
+    // Entries cannot be removed individually, only all at once with clear(),
+    // which suits a hub whose set of relays changes rarely.
+    // V must be default-constructible and should be a small POD.
+    // N is the capacity, in [1,65535]; performance degrades as the map fills.
+    template<class V, uint16_t N>
+    class CC1HouseCodeMap
+        {
+        private:
+            // Key marking an empty slot; 0xff house codes are never valid.
+            static const uint16_t emptyKey = 0xffff;
+            // Packed keys (hc1 << 8 | hc2), or emptyKey.
+            uint16_t keys[N];
+            // Values, parallel to keys.
+            V values[N];
+            // Count of occupied slots.
+            uint16_t used;
+
+            // Pack house code into a single key.
+            static inline uint16_t packKey(const uint8_t hc1, const uint8_t hc2)
+                { return((uint16_t)(((uint16_t)hc1 << 8) | hc2)); }
+            // Initial probe slot for a key; multiplicative hash spreads the usual [0,99] byte values.
+            static inline uint16_t slotFor(const uint16_t key)
+                { return((uint16_t)(((uint16_t)(key * 40503U)) % N)); }
+
+            // Find the slot for the key, or the empty slot at which it would be inserted.
+            // Returns N if the key is absent and the map is full.
+            uint16_t probe(const uint16_t key) const
+                {
+                uint16_t i = slotFor(key);
+                for(uint16_t n = N; n-- > 0; )
+                    {
+                    const uint16_t k = keys[i];
+                    if((key == k) || (emptyKey == k)) { return(i); }
+                    if(++i == N) { i = 0; }
+                    }
+                return(N);
+                }
+
+        public:
+            // Create empty map.
+            CC1HouseCodeMap() { clear(); }
+
+            // Maximum number of entries.
+            static const uint16_t capacity = N;
+
+            // Remove all entries; values are reset to V().
+            void clear()
+                {
+                for(uint16_t i = 0; i < N; ++i) { keys[i] = emptyKey; values[i] = V(); }
+                used = 0;
+                }
+
+            // Number of entries in use.
+            uint16_t size() const { return(used); }
+
+            // Get the value for the given house code, or NULL if absent.
+            V *find(const uint8_t hc1, const uint8_t hc2)
+                {
+                const uint16_t key = packKey(hc1, hc2);
+                const uint16_t i = probe(key);
+                if((N == i) || (key != keys[i])) { return(NULL); }
+                return(values + i);
+                }
+            const V *find(const uint8_t hc1, const uint8_t hc2) const
+                { return(const_cast<CC1HouseCodeMap *>(this)->find(hc1, hc2)); }
+
+            // Get the value for the given house code, inserting a V() if absent.
+            // Returns NULL if the house code is invalid (either byte 0xff) or the map is full.
+            V *findOrInsert(const uint8_t hc1, const uint8_t hc2)
+                {
+                if((0xff == hc1) || (0xff == hc2)) { return(NULL); } // FAIL.
+                const uint16_t key = packKey(hc1, hc2);
+                const uint16_t i = probe(key);
+                if(N == i) { return(NULL); } // FAIL: full.
+                if(emptyKey == keys[i])
+                    {
+                    keys[i] = key;
+                    values[i] = V();
+                    ++used;
+                    }
+                return(values + i);
+                }
+
+            // Iterate over slots: for i in [0,capacity), get house code and value if occupied.
+            // Returns false for an empty slot (or i out of range), in which case outputs are untouched.
+            bool getSlot(const uint16_t i, uint8_t &hc1, uint8_t &hc2, V *&value)
+                {
+                if((i >= N) || (emptyKey == keys[i])) { return(false); }
+                hc1 = (uint8_t)(keys[i] >> 8);
+                hc2 = (uint8_t)keys[i];
+                value = values + i;
+                return(true);
+                }
+            bool getSlot(const uint16_t i, uint8_t &hc1, uint8_t &hc2, const V *&value) const
+                {
+                V *v;
+                if(!const_cast<CC1HouseCodeMap *>(this)->getSlot(i, hc1, hc2, v)) { return(false); }
+                value = v;
+                return(true);
+                }
+        };
+
+    }
+
+
+#endif
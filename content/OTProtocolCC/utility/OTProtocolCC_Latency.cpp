@@ -0,0 +1,113 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+#include "OTProtocolCC_Latency.h"
+#include "OTProtocolCC_OTProtocolCC.h"
+
+#include <Arduino.h>
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+#include <util/atomic.h>
+#endif
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+// Print as "count p50 p99 max | bucket counts..." with no line end.
+void CC1LatencyHistogram::print(Print &p) const
+    {
+    p.print(getCount()); p.print(' ');
+    p.print(getPercentileUpperBound(500)); p.print(' ');
+    p.print(getPercentileUpperBound(990)); p.print(' ');
+    p.print(maxUs); p.print(F(" |"));
+    for(uint8_t i = 0; i < buckets; ++i) { p.print(' '); p.print(counts[i]); }
+    }
+
+// Map a frame type byte to a type index.
+uint8_t CC1DecodeLatency::typeIndex(const uint8_t frameType)
+    {
+    switch(frameType)
+        {
+        case CC1Alert::frame_type: { return(type_alert); }
+        case CC1PollAndCommand::frame_type: { return(type_poll_and_command); }
+        case CC1PollResponse::frame_type: { return(type_poll_response); }
+        default: { return(type_other); }
+        }
+    }
+
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+
+static CC1LatencyHistogram decodeLatency[CC1DecodeLatency::types][CC1DecodeLatency::stages];
+
+// Record one stage latency; safe from ISR and main loop.
+void CC1DecodeLatency::record(const uint8_t type, const uint8_t stage, const uint32_t us)
+    {
+    if((type >= types) || (stage >= stages)) { return; } // FAIL.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { decodeLatency[type][stage].record(us); }
+    }
+
+// Take a consistent copy of one histogram.
+void CC1DecodeLatency::snapshot(const uint8_t type, const uint8_t stage, CC1LatencyHistogram &out)
+    {
+    if((type >= types) || (stage >= stages)) { out.clear(); return; } // FAIL.
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { out = decodeLatency[type][stage]; }
+    }
+
+// Clear all histograms.
+void CC1DecodeLatency::clear()
+    {
+    for(uint8_t t = 0; t < types; ++t)
+        {
+        for(uint8_t s = 0; s < stages; ++s)
+            { ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { decodeLatency[t][s].clear(); } }
+        }
+    }
+
+// Print all non-empty histograms, one per line, as "type stage histogram".
+void CC1DecodeLatency::print(Print &p)
+    {
+    static const char typeNames[types] = { '!', '?', '*', '-' };
+    static const char stageNames[stages] = { 'V', 'C', 'M', 'D' };
+    for(uint8_t t = 0; t < types; ++t)
+        {
+        for(uint8_t s = 0; s < stages; ++s)
+            {
+            CC1LatencyHistogram h;
+            snapshot(t, s, h);
+            if(0 == h.getCount()) { continue; }
+            p.print(typeNames[t]); p.print(' ');
+            p.print(stageNames[s]); p.print(' ');
+            h.print(p);
+            p.println();
+            }
+        }
+    }
+
+CC1LatencyStopwatch::CC1LatencyStopwatch(const uint8_t _type) : type(_type), mark(micros()) { }
+
+// Record the time since construction or the previous lap against the given stage.
+void CC1LatencyStopwatch::lap(const uint8_t stage)
+    {
+    const uint32_t now = micros();
+    CC1DecodeLatency::record(type, stage, now - mark);
+    mark = now;
+    }
+
+#endif
+
+    }
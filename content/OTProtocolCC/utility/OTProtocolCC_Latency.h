@@ -0,0 +1,181 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Log-bucketed latency histograms, and optional per-stage decode latency collection.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_LATENCY_H
+#define ARDUINO_LIB_OTPROTOCOLCC_LATENCY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Uncomment (or define for the whole build) to collect per-stage decode latency histograms.
+// Costs about 550 bytes of RAM and a few micros() calls per decode.
+// When not defined the hooks compile to nothing.
+//#define OTPROTOCOLCC_ENABLE_LATENCY
+
+class Print;
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1LatencyHistogram
+    // Counts of latencies in log-scale microsecond buckets,
+    // so that the tail (eg what threatens the 10s poll response window) is visible, not just the mean:
+    // bucket 0 holds [0,1]us, bucket k in [1,fine_buckets-1] holds [2^k,2^(k+1)-1]us (up to 2047us),
+    // then coarser buckets each 16 times wider: [2048,32767]us, [32768,524287]us, [524288,8388607]us,
+    // and the last bucket holds everything from 2^23us (about 8.4s) up.
+    // Counts saturate rather than wrap.  The maximum seen is also kept, to the microsecond.
+    // 34 bytes on AVR, 36 where uint32_t is 4-byte aligned;
+    // not safe to update from an ISR and the main loop at once without locking.
+    struct CC1LatencyHistogram
+        {
+        // Power-of-two buckets, then coarse buckets each spanning coarse_shift more powers of two.
+        static const uint8_t fine_buckets = 11;
+        static const uint8_t coarse_shift = 4;
+        static const uint8_t buckets = 15;
+        // Largest latency recorded.
+        uint32_t maxUs;
+        uint16_t counts[buckets];
+
+        CC1LatencyHistogram() { clear(); }
+        void clear() { for(uint8_t i = 0; i < buckets; ++i) { counts[i] = 0; } maxUs = 0; }
+
+        // Bucket index for a latency in microseconds.
+        static uint8_t bucketFor(uint32_t us)
+            {
+            uint8_t log2 = 0;
+            while(us > 1) { us >>= 1; ++log2; }
+            if(log2 < fine_buckets) { return(log2); }
+            const uint8_t b = fine_buckets + (log2 - fine_buckets) / coarse_shift;
+            return((b < buckets) ? b : (buckets - 1));
+            }
+        // Inclusive upper bound of bucket i in microseconds; 0xffffffff for the last (open) bucket.
+        static uint32_t bucketUpperBound(const uint8_t i)
+            {
+            if(i >= buckets - 1) { return(0xffffffffUL); }
+            if(i < fine_buckets) { return((2UL << i) - 1); }
+            return((1UL << (fine_buckets + coarse_shift * (i - fine_buckets + 1))) - 1);
+            }
+
+        // Record one latency.
+        void record(const uint32_t us)
+            {
+            uint16_t &c = counts[bucketFor(us)];
+            if(0xffff != c) { ++c; }
+            if(us > maxUs) { maxUs = us; }
+            }
+        // Add all of another histogram (eg a snapshot from another period or node) into this one.
+        void merge(const CC1LatencyHistogram &h)
+            {
+            for(uint8_t i = 0; i < buckets; ++i)
+                {
+                const uint32_t s = (uint32_t)counts[i] + h.counts[i];
+                counts[i] = (s > 0xffff) ? 0xffff : (uint16_t)s;
+                }
+            if(h.maxUs > maxUs) { maxUs = h.maxUs; }
+            }
+        // Total count recorded (possibly understated if buckets saturated).
+        uint32_t getCount() const
+            {
+            uint32_t n = 0;
+            for(uint8_t i = 0; i < buckets; ++i) { n += counts[i]; }
+            return(n);
+            }
+        // Upper bound in microseconds of the latency at or below which permille/1000 of samples fall,
+        // eg 990 for p99; 0 if empty.  Never more than maxUs.
+        uint32_t getPercentileUpperBound(const uint16_t permille) const
+            {
+            const uint32_t n = getCount();
+            if(0 == n) { return(0); }
+            const uint32_t target = (n * permille + 999U) / 1000U;
+            uint32_t seen = 0;
+            for(uint8_t i = 0; i < buckets; ++i)
+                {
+                seen += counts[i];
+                if((seen >= target) && (0 != seen))
+                    {
+                    const uint32_t ub = bucketUpperBound(i);
+                    return((ub < maxUs) ? ub : maxUs);
+                    }
+                }
+            return(maxUs);
+            }
+        // Print as "count p50 p99 max | bucket counts..." with no line end.
+        void print(Print &p) const;
+        };
+
+    // CC1DecodeLatency
+    // Per message type and per decode stage latency histograms, filled by hooks in decodeSimple()
+    // when OTPROTOCOLCC_ENABLE_LATENCY is defined.
+    // Stages are timed consecutively, and only stages that complete are recorded,
+    // so a frame failing CRC records validation time but no CRC time.
+    // Timing uses micros(), so on a 16MHz AVR resolution is 4us.
+    // Dispatch (handing the decoded message on) is outside the library;
+    // application code times it with CC1LatencyStopwatch and record(..., stage_dispatch, ...).
+    class CC1DecodeLatency
+        {
+        public:
+            // Message type index.
+            enum { type_alert, type_poll_and_command, type_poll_response, type_other, types };
+            // Decode stage.
+            enum { stage_validate, stage_crc, stage_materialise, stage_dispatch, stages };
+            // Map a frame type byte to a type index.
+            static uint8_t typeIndex(uint8_t frameType);
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+            // Record one stage latency; safe from ISR and main loop.
+            static void record(uint8_t type, uint8_t stage, uint32_t us);
+            // Take a consistent copy of one histogram; out is cleared if the indices are out of range.
+            static void snapshot(uint8_t type, uint8_t stage, CC1LatencyHistogram &out);
+            // Clear all histograms.
+            static void clear();
+            // Print all non-empty histograms, one per line.
+            static void print(Print &p);
+#endif
+        };
+
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+    // Times consecutive stages of one operation.
+    class CC1LatencyStopwatch
+        {
+        private:
+            const uint8_t type;
+            uint32_t mark;
+        public:
+            explicit CC1LatencyStopwatch(uint8_t _type);
+            // Record the time since construction or the previous lap against the given stage.
+            void lap(uint8_t stage);
+        };
+#endif
+
+    }
+
+// Hooks for decode paths: START once at the top, then STAGE as each stage completes.
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+#define OTPROTOCOLCC_LATENCY_START(frameType) OTProtocolCC::CC1LatencyStopwatch _cc1LatencyStopwatch(OTProtocolCC::CC1DecodeLatency::typeIndex(frameType))
+#define OTPROTOCOLCC_LATENCY_STAGE(stage) _cc1LatencyStopwatch.lap(OTProtocolCC::CC1DecodeLatency::stage)
+#else
+#define OTPROTOCOLCC_LATENCY_START(frameType)
+#define OTPROTOCOLCC_LATENCY_STAGE(stage)
+#endif
+
+
+#endif
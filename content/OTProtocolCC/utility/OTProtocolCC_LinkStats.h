@@ -0,0 +1,204 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Per-link loss and duplicate tracking from CC1 sequence numbers,
+ * and per-relay loss on the poll/response exchange.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_LINKSTATS_H
+#define ARDUINO_LIB_OTPROTOCOLCC_LINKSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_HouseCodeMap.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1SeqStats
+    // Counts frames received, lost and duplicated on one link
+    // from the rolling 7-bit sequence numbers carried by CC1Alert and CC1PollAndCommand.
+    // A jump forward of less than half the sequence space counts the skipped numbers as lost;
+    // a larger jump (in effect backwards) is taken as the sender having restarted,
+    // and counts as a resync rather than as loss.
+    // Counters saturate rather than wrap.
+    // 8 bytes on AVR and common hosts (no member needs more than 2-byte alignment).
+    struct CC1SeqStats
+        {
+        // Last sequence number received, or CC1Base::no_seq if none yet.
+        uint8_t last;
+        // Number of times the sequence restarted.
+        uint8_t resyncs;
+        // Frames received with a sequence number, excluding duplicates.
+        uint16_t received;
+        // Frames inferred lost from gaps in the sequence.
+        uint16_t lost;
+        // Frames received more than once.
+        uint16_t duplicates;
+
+        CC1SeqStats() : last(CC1Base::no_seq), resyncs(0), received(0), lost(0), duplicates(0) { }
+
+        // Update from the (optional) sequence number of a frame that passed its CRC;
+        // frames without a sequence number are ignored.
+        void update(const uint8_t seq)
+            {
+            if(CC1Base::no_seq == seq) { return; }
+            if(CC1Base::no_seq == last) { last = seq; inc(received); return; }
+            const uint8_t d = (seq - last) & CC1Base::seq_mask;
+            if(0 == d) { inc(duplicates); return; }
+            last = seq;
+            inc(received);
+            if(d > (CC1Base::seq_mask >> 1)) { if(0xff != resyncs) { ++resyncs; } return; }
+            const uint16_t gap = d - 1;
+            lost = (lost > (uint16_t)(0xffff - gap)) ? 0xffff : (lost + gap);
+            }
+
+        // Loss as parts per thousand of frames sent, or 0 if nothing heard.
+        uint16_t getLossPermille() const
+            {
+            const uint32_t sent = (uint32_t)received + lost;
+            if(0 == sent) { return(0); }
+            return((uint16_t)(((uint32_t)lost * 1000U) / sent));
+            }
+
+        private:
+            static inline void inc(uint16_t &c) { if(0xffff != c) { ++c; } }
+        };
+
+    // CC1LinkStatsRegistry
+    // Hub-side per-relay sequence statistics keyed by house code, for up to N relays.
+    // Of the frames a hub receives only CC1Alert carries a sequence number (CC1PollResponse has no room for one),
+    // and alerts are rare, so these figures measure loss of alerts only, from few samples;
+    // for loss on the poll/response link use CC1PollLinkStatsRegistry.
+    template<uint16_t N>
+    class CC1LinkStatsRegistry
+        {
+        private:
+            CC1HouseCodeMap<CC1SeqStats, N> stats;
+        public:
+            // Update stats for the relay from a decoded alert.
+            // Returns false if the alert is invalid or the registry is full.
+            bool update(const CC1Alert &a) { return(update(a.getHC1(), a.getHC2(), a.getSeq())); }
+            // Update stats for the relay from the (optional) sequence number of a frame from it.
+            // Returns false if the house code is invalid or the registry is full.
+            bool update(const uint8_t hc1, const uint8_t hc2, const uint8_t seq)
+                {
+                CC1SeqStats *const s = stats.findOrInsert(hc1, hc2);
+                if(NULL == s) { return(false); } // FAIL.
+                s->update(seq);
+                return(true);
+                }
+            // Get stats for relay, or NULL if never seen.
+            const CC1SeqStats *find(const uint8_t hc1, const uint8_t hc2) const { return(stats.find(hc1, hc2)); }
+            // Number of relays tracked.
+            uint16_t size() const { return(stats.size()); }
+            // Reset all stats.
+            void clear() { stats.clear(); }
+        };
+
+    // CC1PollLinkStats
+    // Hub-side counts of polls sent to one relay and of those answered by a poll response within the window,
+    // ie round-trip loss on the poll/response link, which is what sets how often a relay must be polled.
+    // Each poll carries a sequence number, which is repeated while the previous poll is unanswered
+    // (as CC1PollResponseDeltaEncoder relies on to tell that its last response was received).
+    // Both counts are halved together before polls would overflow, so the ratio weights recent polls.
+    // 10 bytes on AVR, 12 where uint32_t is 4-byte aligned.
+    struct CC1PollLinkStats
+        {
+        // When the latest poll was sent (ms).
+        uint32_t sentAt;
+        // Polls sent, and polls answered in time.
+        uint16_t polls;
+        uint16_t answered;
+        // Sequence number of the latest poll, or CC1Base::no_seq before the first.
+        uint8_t seq;
+        // Non-zero while the latest poll is unanswered.
+        uint8_t awaiting;
+
+        CC1PollLinkStats() : sentAt(0), polls(0), answered(0), seq(CC1Base::no_seq), awaiting(0) { }
+
+        // Loss as parts per thousand of polls whose answer is no longer awaited, or 0 if none.
+        uint16_t getLossPermille() const
+            {
+            const uint16_t done = polls - (awaiting ? 1 : 0);
+            if(0 == done) { return(0); }
+            const uint16_t a = (answered > done) ? done : answered;
+            return((uint16_t)(((uint32_t)(done - a) * 1000U) / done));
+            }
+        };
+
+    // CC1PollLinkStatsRegistry
+    // Hub-side CC1PollLinkStats keyed by house code, for up to N relays.
+    // Call beginPoll() for each poll sent to a relay, and send the poll with the sequence number it returns;
+    // call onResponse() for each poll response decoded.
+    // Times are in ms from any free-running clock (eg millis()), and may wrap.
+    template<uint16_t N>
+    class CC1PollLinkStatsRegistry
+        {
+        public:
+            // Time allowed for a poll response before the poll is counted as unanswered.
+            static const uint32_t response_window_ms = 10000UL;
+        private:
+            CC1HouseCodeMap<CC1PollLinkStats, N> stats;
+        public:
+            // Note a poll being sent to the relay at nowMs.
+            // Returns the sequence number to send it with: that of the previous poll if it went unanswered,
+            // else the next in sequence; CC1Base::no_seq if the house code is invalid or the registry is full.
+            uint8_t beginPoll(const uint8_t hc1, const uint8_t hc2, const uint32_t nowMs)
+                {
+                CC1PollLinkStats *const s = stats.findOrInsert(hc1, hc2);
+                if(NULL == s) { return(CC1Base::no_seq); } // FAIL.
+                if(CC1Base::no_seq == s->seq) { s->seq = 0; }
+                else if(!s->awaiting) { s->seq = (s->seq + 1) & CC1Base::seq_mask; }
+                if(0xffff == s->polls) { s->polls >>= 1; s->answered >>= 1; }
+                ++s->polls;
+                s->awaiting = 1;
+                s->sentAt = nowMs;
+                return(s->seq);
+                }
+            // Note a poll response from the relay received at nowMs.
+            // Returns true if it answers the latest poll in time, false if late, unsolicited or from an unknown relay.
+            // A late answer is counted as a loss, but as the hub now holds it the next poll gets a new sequence number.
+            bool onResponse(const uint8_t hc1, const uint8_t hc2, const uint32_t nowMs)
+                {
+                CC1PollLinkStats *const s = stats.find(hc1, hc2);
+                if((NULL == s) || !s->awaiting) { return(false); } // FAIL.
+                s->awaiting = 0;
+                if((nowMs - s->sentAt) >= response_window_ms) { return(false); } // FAIL: late.
+                ++s->answered;
+                return(true);
+                }
+            // Update from a decoded poll response; returns false if it is invalid or does not answer a poll in time.
+            bool onResponse(const CC1PollResponse &r, const uint32_t nowMs)
+                { return(r.isValid() && onResponse(r.getHC1(), r.getHC2(), nowMs)); }
+            // Get stats for relay, or NULL if never polled.
+            const CC1PollLinkStats *find(const uint8_t hc1, const uint8_t hc2) const { return(stats.find(hc1, hc2)); }
+            // Number of relays tracked.
+            uint16_t size() const { return(stats.size()); }
+            // Reset all stats.
+            void clear() { stats.clear(); }
+        };
+
+    }
+
+
+#endif
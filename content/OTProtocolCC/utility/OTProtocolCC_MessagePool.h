@@ -0,0 +1,147 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Fixed-capacity static pools of CC1 message instances, with no heap use.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_MESSAGEPOOL_H
+#define ARDUINO_LIB_OTPROTOCOLCC_MESSAGEPOOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <Arduino.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1MessagePool
+    // Pool of N instances of CC1 message class T (derived from CC1Base),
+    // so that total message memory is fixed at compile time and visible in the link map.
+    // Acquire and release are O(1), via a stack of free slot indices.
+    // Acquired instances are always invalid until decoded into or assigned.
+    // Not safe to share between an ISR and the main loop without external locking.
+    // Costs N * (sizeof(T) + 2) + 3 bytes; N is in [1,254].
+    template<class T, uint8_t N>
+    class CC1MessagePool
+        {
+        private:
+            T items[N];
+            // Indices of free items; the top freeCount entries are valid.
+            uint8_t freeStack[N];
+            // Non-zero for items currently acquired, to catch double and stray releases.
+            uint8_t inUse[N];
+            uint8_t freeCount;
+            // Most items ever in use at once.
+            uint8_t highWater;
+            // Number of failed acquire (pool empty) or release (bad pointer) calls, saturating.
+            uint8_t failures;
+            void fail() { if(0xff != failures) { ++failures; } }
+        public:
+            static const uint8_t capacity = N;
+
+            CC1MessagePool() { clear(); }
+
+            // Release everything and reset statistics.
+            void clear()
+                {
+                for(uint8_t i = 0; i < N; ++i) { freeStack[i] = N - 1 - i; inUse[i] = 0; }
+                freeCount = N;
+                highWater = 0;
+                failures = 0;
+                }
+
+            // Take a (forced invalid) instance from the pool, or NULL if none is free.
+            T *acquire()
+                {
+                if(0 == freeCount) { fail(); return(NULL); } // FAIL.
+                const uint8_t i = freeStack[--freeCount];
+                inUse[i] = 1;
+                const uint8_t n = N - freeCount;
+                if(n > highWater) { highWater = n; }
+                T *const p = items + i;
+                p->forceInvalid();
+                return(p);
+                }
+
+            // Return an instance to the pool.
+            // Returns false and does nothing if p is not currently acquired from this pool.
+            bool release(T *const p)
+                {
+                if((p < items) || (p >= items + N)) { fail(); return(false); } // FAIL.
+                const uint8_t i = (uint8_t)(p - items);
+                if(!inUse[i]) { fail(); return(false); } // FAIL.
+                // Cannot happen while inUse and freeStack agree, but keeps the store in bounds.
+                if(freeCount >= N) { fail(); return(false); } // FAIL.
+                inUse[i] = 0;
+                freeStack[freeCount++] = i;
+                return(true);
+                }
+
+            // Usage counters.
+            uint8_t getInUse() const { return(N - freeCount); }
+            uint8_t getHighWater() const { return(highWater); }
+            uint8_t getFailures() const { return(failures); }
+
+            // Print counters as "name in/high/cap fail" with no line end, eg for serial debug output.
+            void printStats(Print &p, const char *const name) const
+                {
+                p.print(name);
+                p.print(' ');
+                p.print(getInUse());
+                p.print('/');
+                p.print(highWater);
+                p.print('/');
+                p.print(N);
+                p.print(' ');
+                p.print(failures);
+                }
+        };
+
+    // CC1MessageArena
+    // All CC1 message memory for (eg) a relay, with NA alerts, NPAC poll/commands and NPR poll responses.
+    // Typically declared once as a static so that its size is accounted for at link time.
+    template<uint8_t NA, uint8_t NPAC, uint8_t NPR>
+    struct CC1MessageArena
+        {
+        CC1MessagePool<CC1Alert, NA> alerts;
+        CC1MessagePool<CC1PollAndCommand, NPAC> polls;
+        CC1MessagePool<CC1PollResponse, NPR> responses;
+
+        // Release everything and reset statistics.
+        void clear() { alerts.clear(); polls.clear(); responses.clear(); }
+
+        // Print counters for all pools on one line.
+        void printStats(Print &p) const
+            {
+            alerts.printStats(p, "A");
+            p.print(' ');
+            polls.printStats(p, "P");
+            p.print(' ');
+            responses.printStats(p, "R");
+            p.println();
+            }
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,346 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Fixed-length CC1 messages described as compile-time field layouts,
+ * with encoder, decoder, validator and view generated from the layout.
+ *
+ * The layouts are the single description of each fixed-length wire format:
+ * CC1Alert, CC1PollAndCommand and CC1PollResponse encode, decode and validate through them,
+ * behind their usual virtual API, and CC1Message holds a frame of any layout in wire form.
+ * Only fixed 7-byte frames (plus CRC7) can be described;
+ * variable-length frames such as CC1MultiPollAndCommand, CC1GroupCommand and CC1PollResponseDelta cannot.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_MESSAGETEMPLATE_H
+#define ARDUINO_LIB_OTPROTOCOLCC_MESSAGETEMPLATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OTRadioLink.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Field kinds.
+    // Each is a stateless type with the same static interface,
+    // so that a layout can be walked at compile time with no virtual calls:
+    //     static uint8_t get(const uint8_t *buf);     // Logical value.
+    //     static bool isValid(const uint8_t *buf);    // True if the wire value is valid.
+    //     static bool set(uint8_t *buf, uint8_t v);   // False (buf unchanged) if v is out of range.
+    //     static void setDefault(uint8_t *buf);       // Lowest valid value.
+
+    // CC1Field
+    // Value v in [Min,Max] held on the wire as (v + Bias) in Bits bits from bit Shift of byte Offset.
+    template<uint8_t Offset, uint8_t Shift, uint8_t Bits, uint8_t Bias, uint8_t Min, uint8_t Max>
+    struct CC1Field
+        {
+        static const uint8_t offset = Offset;
+        static const uint8_t low_mask = (uint8_t)((1U << Bits) - 1);
+        static const uint8_t mask = (uint8_t)(low_mask << Shift);
+        static inline uint8_t get(const uint8_t *const buf) { return((uint8_t)(((buf[Offset] >> Shift) & low_mask) - Bias)); }
+        static inline bool isValid(const uint8_t *const buf) { const uint8_t v = get(buf); return((v >= Min) && (v <= Max)); }
+        static inline bool set(uint8_t *const buf, const uint8_t v)
+            {
+            if((v < Min) || (v > Max)) { return(false); } // FAIL.
+            buf[Offset] = (uint8_t)((buf[Offset] & ~mask) | ((((uint8_t)(v + Bias)) & low_mask) << Shift));
+            return(true);
+            }
+        static inline void setDefault(uint8_t *const buf) { set(buf, Min); }
+        };
+
+    // CC1Flag
+    // Single-bit boolean (0 or 1) at bit Bit of byte Offset.
+    template<uint8_t Offset, uint8_t Bit>
+    struct CC1Flag : public CC1Field<Offset, Bit, 1, 0, 0, 1> { };
+
+    // CC1FixedByte
+    // Whole byte at Offset that must have value Value (eg a reserved extension byte).
+    template<uint8_t Offset, uint8_t Value>
+    struct CC1FixedByte
+        {
+        static const uint8_t offset = Offset;
+        static inline uint8_t get(const uint8_t *const buf) { return(buf[Offset]); }
+        static inline bool isValid(const uint8_t *const buf) { return(Value == buf[Offset]); }
+        static inline bool set(uint8_t *const buf, const uint8_t v) { if(Value != v) { return(false); } buf[Offset] = v; return(true); } // FAIL if not Value.
+        static inline void setDefault(uint8_t *const buf) { buf[Offset] = Value; }
+        };
+
+    // CC1ReservedByte
+    // Whole byte at Offset written as Default but accepted with any value on decode,
+    // for reserved bytes that older decoders never checked.
+    template<uint8_t Offset, uint8_t Default>
+    struct CC1ReservedByte
+        {
+        static const uint8_t offset = Offset;
+        static inline uint8_t get(const uint8_t *const buf) { return(buf[Offset]); }
+        static inline bool isValid(const uint8_t *) { return(true); }
+        static inline bool set(uint8_t *const buf, const uint8_t v) { buf[Offset] = v; return(true); }
+        static inline void setDefault(uint8_t *const buf) { buf[Offset] = Default; }
+        };
+
+    // CC1SeqField
+    // Optional sequence number at byte Offset, in a reserved extension byte:
+    // absent (CC1Base::no_seq) is sent as the legacy reserved value 1; seq [0,127] is sent as seq+2, ie [2,129].
+    template<uint8_t Offset>
+    struct CC1SeqField
+        {
+        static const uint8_t offset = Offset;
+        static inline uint8_t get(const uint8_t *const buf) { return((uint8_t)(buf[Offset] - 2)); }
+        static inline bool isValid(const uint8_t *const buf) { const uint8_t v = get(buf); return((v <= CC1Base::seq_mask) || (CC1Base::no_seq == v)); }
+        static inline bool set(uint8_t *const buf, const uint8_t v)
+            {
+            if((v > CC1Base::seq_mask) && (CC1Base::no_seq != v)) { return(false); } // FAIL.
+            buf[Offset] = (uint8_t)(v + 2);
+            return(true);
+            }
+        static inline void setDefault(uint8_t *const buf) { buf[Offset] = 1; }
+        };
+
+    // CC1OffsetField
+    // Field F moved Delta bytes further into the buffer,
+    // so that a field group (eg the command bytes) described from offset 0 can be placed within a frame.
+    template<class F, uint8_t Delta>
+    struct CC1OffsetField
+        {
+        static const uint8_t offset = F::offset + Delta;
+        static inline uint8_t get(const uint8_t *const buf) { return(F::get(buf + Delta)); }
+        static inline bool isValid(const uint8_t *const buf) { return(F::isValid(buf + Delta)); }
+        static inline bool set(uint8_t *const buf, const uint8_t v) { return(F::set(buf + Delta, v)); }
+        static inline void setDefault(uint8_t *const buf) { F::setDefault(buf + Delta); }
+        };
+
+    // Compile-time list of fields, built as nested CC1FieldList<F, Next> ending in CC1FieldListEnd,
+    // applying an operation to every field by recursion that the compiler flattens.
+    struct CC1FieldListEnd
+        {
+        static inline bool isValid(const uint8_t *) { return(true); }
+        static inline void setDefaults(uint8_t *) { }
+        };
+    template<class F, class Next>
+    struct CC1FieldList
+        {
+        static inline bool isValid(const uint8_t *const buf) { return(F::isValid(buf) && Next::isValid(buf)); }
+        static inline void setDefaults(uint8_t *const buf) { F::setDefault(buf); Next::setDefaults(buf); }
+        };
+
+    // Field groups shared with the aggregated and delta forms, described from offset 0.
+
+    //     1+rp lf|lt|lc
+    // Command, as carried by CC1PollAndCommand, CC1MultiPollAndCommand and CC1GroupCommand.
+    struct CC1CommandBytesLayout
+        {
+        typedef CC1Field<0, 0, 8, 1, 0, 100> RP;
+        typedef CC1Field<1, 0, 2, 0, 0, 3> LC;
+        typedef CC1Field<1, 2, 4, 0, 1, 15> LT;
+        typedef CC1Field<1, 6, 2, 0, 1, 3> LF;
+        typedef CC1FieldList<RP,
+                CC1FieldList<LC,
+                CC1FieldList<LT,
+                CC1FieldList<LF,
+                CC1FieldListEnd> > > > Fields;
+        };
+
+    //     w|s|1+rh 1+tp 1+tr sy|al|0
+    // Poll response body, as carried by CC1PollResponse and CC1PollResponseDelta.
+    struct CC1PollResponseBodyLayout
+        {
+        typedef CC1Field<0, 0, 6, 1, 0, 50> RH;
+        typedef CC1Flag<0, 6> S;
+        typedef CC1Flag<0, 7> W;
+        typedef CC1Field<1, 0, 8, 1, 0, 199> TP;
+        typedef CC1Field<2, 0, 8, 1, 0, 199> TR;
+        typedef CC1Field<3, 1, 6, 0, 1, 62> AL;
+        typedef CC1Flag<3, 7> SY;
+        typedef CC1FieldList<RH,
+                CC1FieldList<S,
+                CC1FieldList<W,
+                CC1FieldList<TP,
+                CC1FieldList<TR,
+                CC1FieldList<AL,
+                CC1FieldList<SY,
+                CC1FieldListEnd> > > > > > > Fields;
+        };
+
+    // Layouts of the fixed-length messages.
+    // Bytes 0 to 2 (type, hc1, hc2) and the trailing CRC are common and handled by the message classes.
+    // Each layout must describe every byte from 3 to 6 so that nothing goes unvalidated.
+
+    //     '!' hc1 hc2 1 seq 1 1 nzcrc
+    // Only the first extension byte (and seq) is checked on decode.
+    struct CC1AlertLayout
+        {
+        static const uint8_t frame_type = OTRadioLink::FTp2_CC1Alert;
+        typedef CC1FixedByte<3, 1> Ext;
+        typedef CC1SeqField<4> Seq;
+        typedef CC1FieldList<Ext,
+                CC1FieldList<Seq,
+                CC1FieldList<CC1ReservedByte<5, 1>,
+                CC1FieldList<CC1ReservedByte<6, 1>,
+                CC1FieldListEnd> > > > Fields;
+        };
+
+    //     '?' hc1 hc2 1+rp lf|lt|lc 1 seq nzcrc
+    struct CC1PollAndCommandLayout
+        {
+        static const uint8_t frame_type = OTRadioLink::FTp2_CC1PollAndCmd;
+        typedef CC1OffsetField<CC1CommandBytesLayout::RP, 3> RP;
+        typedef CC1OffsetField<CC1CommandBytesLayout::LC, 3> LC;
+        typedef CC1OffsetField<CC1CommandBytesLayout::LT, 3> LT;
+        typedef CC1OffsetField<CC1CommandBytesLayout::LF, 3> LF;
+        typedef CC1FixedByte<5, 1> Ext;
+        typedef CC1SeqField<6> Seq;
+        typedef CC1FieldList<RP,
+                CC1FieldList<LC,
+                CC1FieldList<LT,
+                CC1FieldList<LF,
+                CC1FieldList<Ext,
+                CC1FieldList<Seq,
+                CC1FieldListEnd> > > > > > Fields;
+        };
+
+    //     '*' hc1 hc2 w|s|1+rh 1+tp 1+tr sy|al|0 nzcrc
+    struct CC1PollResponseLayout
+        {
+        static const uint8_t frame_type = OTRadioLink::FTp2_CC1PollResponse;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::RH, 3> RH;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::S, 3> S;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::W, 3> W;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::TP, 3> TP;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::TR, 3> TR;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::AL, 3> AL;
+        typedef CC1OffsetField<CC1PollResponseBodyLayout::SY, 3> SY;
+        typedef CC1FieldList<RH,
+                CC1FieldList<S,
+                CC1FieldList<W,
+                CC1FieldList<TP,
+                CC1FieldList<TR,
+                CC1FieldList<AL,
+                CC1FieldList<SY,
+                CC1FieldListEnd> > > > > > > Fields;
+        };
+
+    // CC1Message
+    // A fixed-length (7 bytes plus CRC7) CC1 message of the given Layout, held in wire form,
+    // so that fields are read and written in place and encoding is a copy plus CRC.
+    // Decoding applies the same checks in the same order as the message classes:
+    // args, frame type, every field (including reserved bytes), CRC, then house code.
+    // A new message type can be handled this way only if it is a fixed 7-byte frame with a CRC7,
+    // and is not then usable where the CC1Base classes are expected.
+    template<class Layout>
+    class CC1Message
+        {
+        public:
+            static const uint8_t frame_type = Layout::frame_type;
+            static const int primary_frame_bytes = 7;
+            static const uint8_t frame_bytes = CC1FrameBytes<primary_frame_bytes>::total;
+        private:
+            // Wire form excluding CRC; buf[0] is 0 when invalid.
+            uint8_t buf[primary_frame_bytes];
+        public:
+            // Create known-invalid instance.
+            CC1Message() { forceInvalid(); }
+            void forceInvalid()
+                {
+                for(uint8_t i = 0; i < primary_frame_bytes; ++i) { buf[i] = 0; }
+                buf[1] = 0xff;
+                buf[2] = 0xff;
+                }
+            // True if decoded or made successfully with a valid house code.
+            bool isValid() const { return((frame_type == buf[0]) && (0xff != buf[1]) && (0xff != buf[2])); }
+            uint8_t getHC1() const { return(buf[1]); }
+            uint8_t getHC2() const { return(buf[2]); }
+
+            // Create instance with the given house code and every field at its default (lowest valid) value.
+            static CC1Message make(const uint8_t hc1, const uint8_t hc2)
+                {
+                CC1Message m;
+                m.buf[0] = frame_type;
+                m.buf[1] = hc1;
+                m.buf[2] = hc2;
+                // Fields sharing a byte are set by read-modify-write, on the zeroes from forceInvalid().
+                Layout::Fields::setDefaults(m.buf);
+                return(m);
+                }
+
+            // Get or set a field of this message's layout, eg m.set<CC1PollResponseLayout::TR>(81).
+            // set() returns false, leaving the message unchanged, if the value is out of range.
+            template<class F> uint8_t get() const { return(F::get(buf)); }
+            template<class F> bool set(const uint8_t v) { return(isValid() && F::set(buf, v)); }
+
+            // True if the frame in buf is a valid message of this layout, including CRC, without copying it.
+            static bool check(const uint8_t *const in, const uint8_t inlen)
+                {
+                if((NULL == in) || (inlen < frame_bytes)) { return(false); } // FAIL.
+                if(frame_type != in[0]) { return(false); } // FAIL.
+                if(!Layout::Fields::isValid(in)) { return(false); } // FAIL.
+                if(!CC1Base::checkFrameCRC(in, inlen, primary_frame_bytes)) { return(false); } // FAIL.
+                return((0xff != in[1]) && (0xff != in[2]));
+                }
+
+            // Encode to the buffer as for CC1Base::encodeSimple().
+            uint8_t encodeSimple(uint8_t *const out, const uint8_t outlen, const bool includeCRC) const
+                {
+                if(!isValid() || (NULL == out) || (outlen < (includeCRC ? frame_bytes : primary_frame_bytes))) { return(0); } // FAIL.
+                for(uint8_t i = 0; i < primary_frame_bytes; ++i) { out[i] = buf[i]; }
+                if(!includeCRC) { return(primary_frame_bytes); }
+                return(CC1Base::appendFrameCRC(out, outlen, primary_frame_bytes));
+                }
+
+            // Decode from the wire as for CC1Base::decodeSimple().
+            // Returns number of bytes read, 0 if unsuccessful; also check isValid().
+            uint8_t decodeSimple(const uint8_t *const in, const uint8_t inlen)
+                {
+                forceInvalid();
+                if((NULL == in) || (inlen < frame_bytes)) { return(0); } // FAIL.
+                if(frame_type != in[0]) { return(0); } // FAIL.
+                if(!Layout::Fields::isValid(in)) { return(0); } // FAIL.
+                if(!CC1Base::checkFrameCRC(in, inlen, primary_frame_bytes)) { return(0); } // FAIL.
+                // As for CC1Base an 0xff house code is copied but leaves the instance invalid.
+                for(uint8_t i = 0; i < primary_frame_bytes; ++i) { buf[i] = in[i]; }
+                return(frame_bytes);
+                }
+        };
+
+    // CC1MessageView
+    // Read-only view of a received frame of the given Layout in a caller's buffer,
+    // validated once on construction, with fields then read in place with no copy.
+    template<class Layout>
+    class CC1MessageView
+        {
+        private:
+            const uint8_t *const buf;
+            const bool valid;
+        public:
+            CC1MessageView(const uint8_t *const _buf, const uint8_t buflen)
+              : buf(_buf), valid(CC1Message<Layout>::check(_buf, buflen)) { }
+            bool isValid() const { return(valid); }
+            uint8_t getHC1() const { return(buf[1]); }
+            uint8_t getHC2() const { return(buf[2]); }
+            // Only meaningful when isValid().
+            template<class F> uint8_t get() const { return(F::get(buf)); }
+        };
+
+    }
+
+
+#endif
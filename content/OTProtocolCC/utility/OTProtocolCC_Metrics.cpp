@@ -0,0 +1,185 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+#include "OTProtocolCC_Metrics.h"
+
+#include <Arduino.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+// Inclusive upper bounds of the finite poll RTT buckets in ms, up to the 10s response window.
+static const uint16_t rttBucketBounds[CC1RttHistogram::buckets - 1] PROGMEM =
+    { 50, 100, 250, 500, 1000, 2000, 4000, 6000, 8000, 10000 };
+
+// Inclusive upper bound of bucket i in ms; 0xffff for the last (open) bucket.
+uint16_t CC1RttHistogram::bucketUpperBound(const uint8_t i)
+    {
+    if(i >= buckets - 1) { return(0xffff); }
+    return(pgm_read_word(rttBucketBounds + i));
+    }
+
+// Bucket index for a round trip time in ms.
+uint8_t CC1RttHistogram::bucketFor(const uint16_t ms)
+    {
+    uint8_t b = 0;
+    while((b < buckets - 1) && (ms > pgm_read_word(rttBucketBounds + b))) { ++b; }
+    return(b);
+    }
+
+// Zero all counters.
+void CC1Metrics::clear()
+    {
+    for(uint8_t i = 0; i < types; ++i) { decoded[i] = 0; }
+    for(uint8_t i = 0; i < fails; ++i) { failures[i] = 0; }
+    dedupHits = 0;
+    rxQueueDepth = 0;
+    rxQueueDropped = 0;
+    pollRtt.clear();
+    pollRttSumMs = 0;
+    }
+
+// Map a frame type byte to a type index.
+uint8_t CC1Metrics::typeIndex(const uint8_t frameType)
+    {
+    switch(frameType)
+        {
+        case CC1Alert::frame_type: { return(type_alert); }
+        case CC1PollAndCommand::frame_type: { return(type_poll_and_command); }
+        case CC1PollResponse::frame_type: { return(type_poll_response); }
+        case CC1PollResponseDelta::frame_type: { return(type_poll_response_delta); }
+        case CC1MultiPollAndCommand::frame_type: { return(type_multi_poll_and_command); }
+        case CC1GroupCommand::frame_type: { return(type_group_command); }
+        default: { return(type_other); }
+        }
+    }
+
+// Classify why a frame failed to decode.
+uint8_t CC1Metrics::classifyFailure(const uint8_t *const buf, const uint8_t buflen)
+    {
+    if((NULL == buf) || (0 == buflen)) { return(fail_short); }
+    const uint8_t t = typeIndex(buf[0]);
+    if(type_other == t) { return(fail_type); }
+    // Compact responses are checked against their base, which is not available here.
+    if(type_poll_response_delta == t) { return(fail_delta); }
+    const uint8_t len = CC1Base::getFrameLength(buf, buflen);
+    if((0 == len) || (buflen < len + CC1Base::crcBytesForLength(len))) { return(fail_short); }
+    if(!CC1Base::checkFrameCRC(buf, buflen, len)) { return(fail_crc); }
+    return(fail_field);
+    }
+
+// Decode into m via decodeSimple() and count the result.
+uint8_t CC1Metrics::decode(CC1Base &m, const uint8_t *const buf, const uint8_t buflen)
+    {
+    const uint8_t n = m.decodeSimple(buf, buflen);
+    if((0 != n) && m.isValid()) { countDecoded(buf[0]); }
+    else { countFailure(buf, buflen); }
+    return(n);
+    }
+
+// Record a poll-to-response round trip time.
+void CC1Metrics::recordPollRtt(const uint16_t ms)
+    {
+    pollRtt.record(ms);
+    const uint32_t s = pollRttSumMs + ms;
+    pollRttSumMs = (s < pollRttSumMs) ? 0xffffffffUL : s;
+    }
+
+// Print "name{label="value"} n" and a line end.
+static void printSample(Print &p, const __FlashStringHelper *const name,
+                        const __FlashStringHelper *const label, const __FlashStringHelper *const value,
+                        const uint32_t n)
+    {
+    p.print(name);
+    if(NULL != label) { p.print('{'); p.print(label); p.print(F("=\"")); p.print(value); p.print(F("\"}")); }
+    p.print(' ');
+    p.println(n);
+    }
+
+// Print "# TYPE name kind" line.
+// Print a time in ms as seconds, eg 250 as 0.25, as Prometheus expects base units, without floating point.
+static void printMsAsSeconds(Print &p, const uint32_t ms)
+    {
+    p.print(ms / 1000U);
+    uint16_t frac = (uint16_t)(ms % 1000U);
+    if(0 == frac) { return; }
+    p.print('.');
+    for(uint16_t d = 100; (0 != frac) && (0 != d); d /= 10) { p.print((char)('0' + (frac / d))); frac %= d; }
+    }
+
+static void printType(Print &p, const __FlashStringHelper *const name, const __FlashStringHelper *const kind)
+    {
+    p.print(F("# TYPE ")); p.print(name); p.print(' '); p.println(kind);
+    }
+
+// Write all metrics in Prometheus text exposition format.
+void CC1Metrics::printPrometheus(Print &p) const
+    {
+    const __FlashStringHelper *const counter = F("counter");
+    const __FlashStringHelper *const gauge = F("gauge");
+
+    const __FlashStringHelper *const decodedName = F("otcc_frames_decoded_total");
+    printType(p, decodedName, counter);
+    const __FlashStringHelper *const typeLabel = F("type");
+    printSample(p, decodedName, typeLabel, F("alert"), decoded[type_alert]);
+    printSample(p, decodedName, typeLabel, F("poll_and_command"), decoded[type_poll_and_command]);
+    printSample(p, decodedName, typeLabel, F("poll_response"), decoded[type_poll_response]);
+    printSample(p, decodedName, typeLabel, F("poll_response_delta"), decoded[type_poll_response_delta]);
+    printSample(p, decodedName, typeLabel, F("multi_poll_and_command"), decoded[type_multi_poll_and_command]);
+    printSample(p, decodedName, typeLabel, F("group_command"), decoded[type_group_command]);
+    printSample(p, decodedName, typeLabel, F("other"), decoded[type_other]);
+
+    const __FlashStringHelper *const failName = F("otcc_decode_failures_total");
+    printType(p, failName, counter);
+    const __FlashStringHelper *const reasonLabel = F("reason");
+    printSample(p, failName, reasonLabel, F("short"), failures[fail_short]);
+    printSample(p, failName, reasonLabel, F("type"), failures[fail_type]);
+    printSample(p, failName, reasonLabel, F("crc"), failures[fail_crc]);
+    printSample(p, failName, reasonLabel, F("field"), failures[fail_field]);
+    printSample(p, failName, reasonLabel, F("delta"), failures[fail_delta]);
+
+    const __FlashStringHelper *const dedupName = F("otcc_dedup_hits_total");
+    printType(p, dedupName, counter);
+    printSample(p, dedupName, NULL, NULL, dedupHits);
+
+    const __FlashStringHelper *const depthName = F("otcc_rx_queue_depth");
+    printType(p, depthName, gauge);
+    printSample(p, depthName, NULL, NULL, rxQueueDepth);
+    // Saturates at the source, so not a counter.
+    const __FlashStringHelper *const droppedName = F("otcc_rx_queue_dropped");
+    printType(p, droppedName, gauge);
+    printSample(p, droppedName, NULL, NULL, rxQueueDropped);
+
+    // Cumulative buckets, as Prometheus histograms require, in seconds (the base unit) though held in ms.
+    printType(p, F("otcc_poll_rtt_seconds"), F("histogram"));
+    uint32_t cumulative = 0;
+    for(uint8_t i = 0; i < CC1RttHistogram::buckets; ++i)
+        {
+        cumulative += pollRtt.counts[i];
+        p.print(F("otcc_poll_rtt_seconds_bucket{le=\""));
+        if(i < CC1RttHistogram::buckets - 1) { printMsAsSeconds(p, CC1RttHistogram::bucketUpperBound(i)); }
+        else { p.print(F("+Inf")); }
+        p.print(F("\"} "));
+        p.println(cumulative);
+        }
+    p.print(F("otcc_poll_rtt_seconds_sum ")); printMsAsSeconds(p, pollRttSumMs); p.println();
+    p.print(F("otcc_poll_rtt_seconds_count ")); p.println(cumulative);
+    }
+
+    }
@@ -0,0 +1,137 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Codec and hub operational counters, printable in Prometheus text format.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_METRICS_H
+#define ARDUINO_LIB_OTPROTOCOLCC_METRICS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+
+class Print;
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1RttHistogram
+    // Counts of poll-to-response round trip times in fixed millisecond buckets
+    // spanning the 10s response window, each holding times up to and including its bound;
+    // the last bucket holds everything longer (ie late or very delayed responses).
+    // Counts saturate rather than wrap.
+    // 22 bytes.
+    struct CC1RttHistogram
+        {
+        static const uint8_t buckets = 11;
+        uint16_t counts[buckets];
+
+        CC1RttHistogram() { clear(); }
+        void clear() { for(uint8_t i = 0; i < buckets; ++i) { counts[i] = 0; } }
+        // Inclusive upper bound of bucket i in ms; 0xffff for the last (open) bucket.
+        static uint16_t bucketUpperBound(uint8_t i);
+        // Bucket index for a round trip time in ms.
+        static uint8_t bucketFor(uint16_t ms);
+        // Record one round trip time.
+        void record(const uint16_t ms) { uint16_t &c = counts[bucketFor(ms)]; if(0xffff != c) { ++c; } }
+        // Total count recorded (possibly understated if buckets saturated).
+        uint32_t getCount() const
+            {
+            uint32_t n = 0;
+            for(uint8_t i = 0; i < buckets; ++i) { n += counts[i]; }
+            return(n);
+            }
+        };
+
+    // CC1Metrics
+    // Counters fed by the codec and hub components:
+    // frames decoded per type, decode failures per reason, replay/duplicate hits,
+    // RX queue depth and drops, and poll-to-response round trip times
+    // (recorded in ms but exported in seconds, the Prometheus base unit).
+    // printPrometheus() writes them in Prometheus text exposition format to any Print,
+    // eg Serial, for a host-side collector to scrape or forward.
+    // Updates are plain increments with no locking, so each instance must only be updated
+    // from one context (normally the main loop); ISR-side counts such as RX queue drops
+    // are copied in with setRxQueue().
+    // About 80 bytes.
+    class CC1Metrics
+        {
+        public:
+            // Frame types counted separately.
+            enum { type_alert, type_poll_and_command, type_poll_response, type_poll_response_delta,
+                   type_multi_poll_and_command, type_group_command, type_other, types };
+            // Reasons for decode failure, as classified by classifyFailure().
+            enum { fail_short, fail_type, fail_crc, fail_field, fail_delta, fails };
+
+        private:
+            uint32_t decoded[types];
+            uint32_t failures[fails];
+            uint32_t dedupHits;
+            uint8_t rxQueueDepth;
+            // Copied from the RX queue, which saturates it at 255.
+            uint8_t rxQueueDropped;
+            // Poll round trip times in ms.
+            CC1RttHistogram pollRtt;
+            uint32_t pollRttSumMs;
+
+            static inline void inc(uint32_t &c) { if(0xffffffffUL != c) { ++c; } }
+
+        public:
+            CC1Metrics() { clear(); }
+            // Zero all counters.
+            void clear();
+
+            // Map a frame type byte to a type index.
+            static uint8_t typeIndex(uint8_t frameType);
+            // Classify why a frame failed to decode, by checking in turn
+            // length, type, CRC (not possible for compact responses which need their base) and otherwise fields.
+            // For use only after a failure, since this repeats the CRC computation.
+            static uint8_t classifyFailure(const uint8_t *buf, uint8_t buflen);
+
+            // Count a successfully decoded frame of the given type.
+            void countDecoded(const uint8_t frameType) { inc(decoded[typeIndex(frameType)]); }
+            // Count a frame that failed to decode.
+            void countFailure(const uint8_t *const buf, const uint8_t buflen) { inc(failures[classifyFailure(buf, buflen)]); }
+            // Decode into m via decodeSimple() and count the result.
+            uint8_t decode(CC1Base &m, const uint8_t *buf, uint8_t buflen);
+            // Count a frame rejected as a replay or duplicate.
+            void countDedupHit() { inc(dedupHits); }
+            // Set the current RX queue depth and total dropped frames (eg from CC1RelayRxQueue getDepth() and getDropped()).
+            // The dropped count saturates at 255 in the queue, so is exported as a gauge rather than a counter.
+            void setRxQueue(const uint8_t depth, const uint8_t dropped) { rxQueueDepth = depth; rxQueueDropped = dropped; }
+            // Record a poll-to-response round trip time.
+            void recordPollRtt(uint16_t ms);
+
+            // Getters.
+            uint32_t getDecoded(const uint8_t type) const { return((type < types) ? decoded[type] : 0); }
+            uint32_t getFailures(const uint8_t reason) const { return((reason < fails) ? failures[reason] : 0); }
+            uint32_t getDedupHits() const { return(dedupHits); }
+            const CC1RttHistogram &getPollRtt() const { return(pollRtt); }
+
+            // Write all metrics in Prometheus text exposition format.
+            void printPrometheus(Print &p) const;
+        };
+
+    }
+
+
+#endif
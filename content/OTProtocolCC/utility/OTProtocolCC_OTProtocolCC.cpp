@@ -18,7 +18,11 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015
 */
 
 #include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_MessageTemplate.h"
+#include "OTProtocolCC_Trace.h"
+#include "OTProtocolCC_Latency.h"
 
+#include <string.h>
 #include <Arduino.h>
 #include <OTRadioLink.h>
 
@@ -26,6 +30,54 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015
 namespace OTProtocolCC
     {
 
+// CRC7_5B remainders of each high nibble of the CRC register, with the 7-bit CRC held left-aligned.
+// The CRC is linear, so a byte is folded in as two nibble lookups instead of eight shift/xor steps,
+// giving the same result as OTRadioLink::crc7_5B_update() from a table of only 16 bytes in flash.
+static const uint8_t crc7_5B_nibble[16] PROGMEM =
+    { 0x00, 0x6e, 0xdc, 0xb2, 0xd6, 0xb8, 0x0a, 0x64, 0xc2, 0xac, 0x1e, 0x70, 0x14, 0x7a, 0xc8, 0xa6 };
+// Fold one byte into the left-aligned CRC register.
+static inline uint8_t crc7_5B_updateLeft(uint8_t r, const uint8_t datum)
+    {
+    r ^= datum;
+    r = (uint8_t)(r << 4) ^ pgm_read_byte(crc7_5B_nibble + (r >> 4));
+    r = (uint8_t)(r << 4) ^ pgm_read_byte(crc7_5B_nibble + (r >> 4));
+    return(r);
+    }
+// Fold one byte into the left-aligned CRC register bitwise, in time independent of the data.
+// Each step applies the polynomial under a mask made from the top bit, with no branch.
+static inline uint8_t crc7_5B_updateLeftConstantTime(uint8_t r, const uint8_t datum)
+    {
+    r ^= datum;
+    for(uint8_t i = 8; i-- > 0; )
+        { r = (uint8_t)(r << 1) ^ (0x6e & (uint8_t)-(uint8_t)(r >> 7)); }
+    return(r);
+    }
+// Update the CRC as OTRadioLink::crc7_5B_update() does, with the kernel selected at compile time.
+static inline uint8_t crc7_5B_update(const uint8_t crc, const uint8_t datum)
+    {
+#if defined(OTPROTOCOLCC_CRC7_NIBBLE_TABLE)
+    return(crc7_5B_updateLeft((uint8_t)(crc << 1), datum) >> 1);
+#elif defined(OTPROTOCOLCC_CRC7_CONSTANT_TIME)
+    return(crc7_5B_updateLeftConstantTime((uint8_t)(crc << 1), datum) >> 1);
+#else
+    return(OTRadioLink::crc7_5B_update(crc, datum));
+#endif
+    }
+// Fold one byte into the left-aligned CRC register with the fastest kernel permitted by the build,
+// ie constant-time if selected, else the nibble table.
+static inline uint8_t crc7_5B_updateLeftBatch(const uint8_t r, const uint8_t datum)
+    {
+#if defined(OTPROTOCOLCC_CRC7_CONSTANT_TIME)
+    return(crc7_5B_updateLeftConstantTime(r, datum));
+#else
+    return(crc7_5B_updateLeft(r, datum));
+#endif
+    }
+
+// Update a CRC7_5B with one byte, with the kernel selected at compile time.
+uint8_t CC1Base::crc7Update(const uint8_t crc, const uint8_t datum)
+    { return(crc7_5B_update(crc, datum)); }
+
 // Compute the (non-zero) CRC for simple messages, for encode or decode.
 // Nominally looks at the message type to decide who many bytes to apply the CRC to.
 // The result should match the actual CRC on decode,
@@ -34,9 +86,16 @@ namespace OTProtocolCC
 uint8_t CC1Base::computeSimpleCRC(const uint8_t *buf, uint8_t buflen)
     {
     // Assume a fixed message length.
-    const uint8_t len = 7;
+    return(computeCRC7(buf, buflen, 7));
+    }
 
-    if(buflen < len) { return(0); } // FAIL
+// Compute the (non-zero) CRC7_5B as for computeSimpleCRC(), but over the first len bytes.
+// Returns 0 (invalid) if the buffer is too short or the message otherwise invalid.
+uint8_t CC1Base::computeCRC7(const uint8_t *const buf, const uint8_t buflen, const uint8_t len)
+    {
+    // Traced here as every CC1 CRC7 encode and check comes through this.
+    OTPROTOCOLCC_TRACE_CRC(buf, buflen);
+    if((0 == len) || (buflen < len)) { return(0); } // FAIL
 
     // Start with first (type) byte, which should always be non-zero.
     // NOTE: this does not start with a separate (eg -1) value, nor invert the result, to save time for these fixed length messages.
@@ -44,11 +103,122 @@ uint8_t CC1Base::computeSimpleCRC(const uint8_t *buf, uint8_t buflen)
     if(0 == crc) { return(0); } // FAIL.
 
     for(uint8_t i = 1; i < len; ++i)
-        { crc = OTRadioLink::crc7_5B_update(crc, buf[i]); }
+        { crc = crc7_5B_update(crc, buf[i]); }
+
+    // Replace a zero CRC value with a non-zero.
+    if(0 != crc) { return(OTPROTOCOLCC_TRACE_RESULT(crc)); }
+    return(OTPROTOCOLCC_TRACE_RESULT(OTRadioLink::crc7_5B_update_nz_ALT));
+    }
+
+// Verify the CRCs of n whole fixed-length (7 bytes plus CRC7) frames.
+// Returns the number of frames that passed.
+size_t CC1Base::verifyCRCBatch(const uint8_t (*const frames)[8], const size_t n, uint8_t *const okMask)
+    {
+    if((NULL == frames) || (NULL == okMask)) { return(0); } // FAIL.
+    size_t passed = 0;
+    uint8_t bits = 0;
+    for(size_t i = 0; i < n; ++i)
+        {
+        const uint8_t *const f = frames[i];
+        // Loop unrolled over the fixed frame length, with the CRC kept left-aligned throughout.
+        uint8_t r = (uint8_t)(f[0] << 1);
+        r = crc7_5B_updateLeftBatch(r, f[1]);
+        r = crc7_5B_updateLeftBatch(r, f[2]);
+        r = crc7_5B_updateLeftBatch(r, f[3]);
+        r = crc7_5B_updateLeftBatch(r, f[4]);
+        r = crc7_5B_updateLeftBatch(r, f[5]);
+        r = crc7_5B_updateLeftBatch(r, f[6]);
+        uint8_t crc = r >> 1;
+        if(0 == crc) { crc = OTRadioLink::crc7_5B_update_nz_ALT; }
+        const uint8_t bit = (uint8_t)(1 << (i & 7));
+        if((0 != f[0]) && (crc == f[7])) { bits |= bit; ++passed; }
+        if((7 == (i & 7)) || (i + 1 == n)) { okMask[i >> 3] = bits; bits = 0; }
+        }
+    return(passed);
+    }
 
+// Compute the (non-zero) 16-bit CRC for messages longer than CRC7_5B is good for.
+// Returns 0 (invalid) if the buffer is too short or the message otherwise invalid.
+uint16_t CC1Base::computeLongCRC(const uint8_t *const buf, const uint8_t buflen, const uint8_t len)
+    {
+    if((NULL == buf) || (0 == len) || (buflen < len)) { return(0); } // FAIL
+    // First (type) byte should always be non-zero.
+    if(0 == buf[0]) { return(0); } // FAIL.
+    uint16_t crc = 0xffff;
+    for(uint8_t i = 0; i < len; ++i)
+        { crc = crc16CCITTUpdate(crc, buf[i]); }
     // Replace a zero CRC value with a non-zero.
     if(0 != crc) { return(crc); }
-    return(OTRadioLink::crc7_5B_update_nz_ALT);
+    return(1);
+    }
+
+// Append the CRC appropriate to the frame length after the first len bytes.
+// Returns len plus the number of CRC bytes on success, else 0.
+uint8_t CC1Base::appendFrameCRC(uint8_t *const buf, const uint8_t buflen, const uint8_t len)
+    {
+    if(!encodeArgsSane(buf, buflen, len, true)) { return(0); } // FAIL.
+    if(1 == crcBytesForLength(len))
+        {
+        const uint8_t crc = computeCRC7(buf, buflen, len);
+        if(0 == crc) { return(0); } // FAIL.
+        buf[len] = crc;
+        return(len + 1);
+        }
+    const uint16_t crc = computeLongCRC(buf, buflen, len);
+    if(0 == crc) { return(0); } // FAIL.
+    buf[len] = (uint8_t)(crc >> 8);
+    buf[len + 1] = (uint8_t)crc;
+    return(len + 2);
+    }
+
+// True iff the CRC appropriate to the frame length is present after the first len bytes and correct.
+bool CC1Base::checkFrameCRC(const uint8_t *const buf, const uint8_t buflen, const uint8_t len)
+    {
+    if(!decodeArgsSane(buf, buflen, len, true)) { return(false); } // FAIL.
+    if(1 == crcBytesForLength(len))
+        {
+        // A zero computed CRC (failure) never matches since a zero CRC byte is never sent.
+        const uint8_t crc = computeCRC7(buf, buflen, len);
+        return((0 != crc) && (crc == buf[len]));
+        }
+    const uint16_t crc = computeLongCRC(buf, buflen, len);
+    return((0 != crc) && ((uint8_t)(crc >> 8) == buf[len]) && ((uint8_t)crc == buf[len + 1]));
+    }
+
+// Get the length of a CC1 frame (including leading type, excluding CRC) from as much of its start as has been received.
+// Returns 0 if the frame type is not known or more of the frame is needed to tell.
+uint8_t CC1Base::getFrameLength(const uint8_t *const buf, const uint8_t buflen)
+    {
+    if((NULL == buf) || (0 == buflen)) { return(0); } // FAIL.
+    switch(buf[0])
+        {
+        case CC1Alert::frame_type: { return(CC1Alert::primary_frame_bytes); }
+        case CC1PollAndCommand::frame_type: { return(CC1PollAndCommand::primary_frame_bytes); }
+        case CC1PollResponse::frame_type: { return(CC1PollResponse::primary_frame_bytes); }
+        case CC1MultiPollAndCommand::frame_type:
+            {
+            if(buflen < 2) { return(0); } // Need count.
+            const uint8_t n = buf[1];
+            if((0 == n) || (n > CC1MultiPollAndCommand::max_entries)) { return(0); } // FAIL.
+            return(CC1MultiPollAndCommand::header_bytes + (n * CC1MultiPollAndCommand::entry_bytes));
+            }
+        case CC1GroupCommand::frame_type:
+            {
+            if(buflen < 3) { return(0); } // Need nb.
+            const uint8_t nb = buf[2];
+            if((0 == nb) || (nb > CC1GroupCommand::max_bitmap_bytes)) { return(0); } // FAIL.
+            return(CC1GroupCommand::header_bytes + nb);
+            }
+        case CC1PollResponseDelta::frame_type:
+            {
+            if(buflen < 4) { return(0); } // Need mask.
+            uint8_t changed = 0;
+            for(uint8_t m = buf[3] & 0xf; 0 != m; m >>= 1) { changed += (m & 1); }
+            if(changed > CC1PollResponseDelta::max_changed_bytes) { return(0); } // FAIL.
+            return(CC1PollResponseDelta::min_frame_bytes + changed);
+            }
+        }
+    return(0); // Unknown type.
     }
 
 // Encode in simple form to the uint8_t array (no auth/enc).
@@ -56,17 +226,15 @@ uint8_t CC1Base::computeSimpleCRC(const uint8_t *buf, uint8_t buflen)
 // 0 if not successful, eg because the buffer is too small.
 uint8_t CC1Alert::encodeSimple(uint8_t *const buf, const uint8_t buflen, const bool includeCRC) const
     {
+    OTPROTOCOLCC_TRACE_ENCODE(frame_type, hc1, hc2);
     if(!encodeSimpleArgsSane(buf, buflen, includeCRC)) { return(0); } // FAIL.
     buf[0] = frame_type; // OTRadioLink::FTp2_CC1Alert;
     buf[1] = hc1;
     buf[2] = hc2;
-    buf[3] = 1;
-    buf[4] = 1;
-    buf[5] = 1;
-    buf[6] = 1;
-    if(!includeCRC) { return(7); }
-    buf[7] = computeSimpleCRC(buf, buflen); // CRC computation should never fail here.
-    return(8);
+    CC1AlertLayout::Fields::setDefaults(buf);
+    CC1AlertLayout::Seq::set(buf, seq);
+    if(!includeCRC) { return(OTPROTOCOLCC_TRACE_RESULT(primary_frame_bytes)); }
+    return(OTPROTOCOLCC_TRACE_RESULT(appendFrameCRC(buf, buflen, primary_frame_bytes))); // CRC computation should never fail here.
     }
 
 
@@ -75,21 +243,27 @@ uint8_t CC1Alert::encodeSimple(uint8_t *const buf, const uint8_t buflen, const b
 // Returns number of bytes read, 0 if unsuccessful; also check isValid().
 uint8_t CC1Alert::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
     {
+    OTPROTOCOLCC_TRACE_DECODE(buf, buflen);
+    OTPROTOCOLCC_LATENCY_START(frame_type);
     forceInvalid(); // Invalid by default.
     // Validate args.
     if(!decodeSimpleArgsSane(buf, buflen, true)) { return(0); } // FAIL.
     // Check frame type.
     if(frame_type /* OTRadioLink::FTp2_CC1Alert */ != buf[0]) { return(0); } // FAIL.
-    // Explicitly test at least first extension byte is as expected.
-    if(1 != buf[3]) { return(0); } // FAIL.
+    // Check first extension byte and optional sequence number.
+    if(!CC1AlertLayout::Fields::isValid(buf)) { return(0); } // FAIL.
+    seq = CC1AlertLayout::Seq::get(buf);
+    OTPROTOCOLCC_LATENCY_STAGE(stage_validate);
     // Check CRC.
-    if(computeSimpleCRC(buf, buflen) != buf[7]) { return(0); } // FAIL.
+    if(!checkFrameCRC(buf, buflen, primary_frame_bytes)) { return(0); } // FAIL.
+    OTPROTOCOLCC_LATENCY_STAGE(stage_crc);
     // Extract house code.
     hc1 = buf[1];
     hc2 = buf[2];
     // Instance will be valid if house code is.
     // Reads a fixed number of bytes when successful.
-    return(8);
+    OTPROTOCOLCC_LATENCY_STAGE(stage_materialise);
+    return(OTPROTOCOLCC_TRACE_RESULT(CC1FrameBytes<primary_frame_bytes>::total));
     }
 
 // Factory method to create instance.
@@ -99,10 +273,12 @@ uint8_t CC1Alert::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
 //   * light-colour         [0,3] bit flags 1==red 2==green (lc) 0 => stop everything
 //   * light-on-time        [1,15] (0 not allowed) 30-450s in units of 30s (lt) ???
 //   * light-flash          [1,3] (0 not allowed) 1==single 2==double 3==on (lf)
+//   * seq  optional rolling sequence number, taken modulo 128; no_seq for the legacy form
 // Returns instance; check isValid().
 CC1PollAndCommand CC1PollAndCommand::make(const uint8_t hc1, const uint8_t hc2,
                                           const uint8_t rp,
-                                          const uint8_t lc, const uint8_t lt, const uint8_t lf)
+                                          const uint8_t lc, const uint8_t lt, const uint8_t lf,
+                                          const uint8_t seq)
     {
     CC1PollAndCommand r;
     r.hc1 = hc1;
@@ -111,26 +287,53 @@ CC1PollAndCommand CC1PollAndCommand::make(const uint8_t hc1, const uint8_t hc2,
     r.lc = lc & 3; // Logical bit pattern for LEDs.
     r.lt = constrain(lt, 1, 15);
     r.lf = constrain(lf, 1, 3);
+    r.seq = (no_seq == seq) ? no_seq : (seq & seq_mask);
     return(r);
     }
 
+// Encode rp/lc/lt/lf to the two wire bytes at buf.
+//     1+rp lf|lt|lc
+void CC1PollAndCommand::encodeCommandBytes(uint8_t *const buf) const
+    {
+    // Fields sharing a byte are set by read-modify-write, so clear first.
+    buf[0] = 0;
+    buf[1] = 0;
+    CC1CommandBytesLayout::RP::set(buf, rp);
+    CC1CommandBytesLayout::LC::set(buf, lc);
+    CC1CommandBytesLayout::LT::set(buf, lt);
+    CC1CommandBytesLayout::LF::set(buf, lf);
+    }
+
+// Decode and validate rp/lc/lt/lf from the two wire bytes at buf.
+// Returns false if any value is invalid.
+//     1+rp lf|lt|lc
+bool CC1PollAndCommand::decodeCommandBytes(const uint8_t *const buf)
+    {
+    // Check inbound values for validity.
+    if(!CC1CommandBytesLayout::Fields::isValid(buf)) { return(false); } // FAIL.
+    rp = CC1CommandBytesLayout::RP::get(buf);
+    lc = CC1CommandBytesLayout::LC::get(buf);
+    lt = CC1CommandBytesLayout::LT::get(buf);
+    lf = CC1CommandBytesLayout::LF::get(buf);
+    return(true);
+    }
+
 // Encode in simple form to the uint8_t array (no auth/enc).
 // Returns number of bytes written if successful,
 // 0 if not successful, eg because the buffer is too small.
 //     '?' hc1 hc2 1+rp lf|lt|lc 1 1 nzcrc
 uint8_t CC1PollAndCommand::encodeSimple(uint8_t *const buf, const uint8_t buflen, const bool includeCRC) const
     {
+    OTPROTOCOLCC_TRACE_ENCODE(frame_type, hc1, hc2);
     if(!encodeSimpleArgsSane(buf, buflen, includeCRC)) { return(0); } // FAIL.
     buf[0] = frame_type; // OTRadioLink::FTp2_CC1Alert;
     buf[1] = hc1;
     buf[2] = hc2;
-    buf[3] = rp + 1;
-    buf[4] = (lf << 6) | ((lt << 2) & 0x3c) | (lc & 3);
-    buf[5] = 1;
-    buf[6] = 1;
-    if(!includeCRC) { return(7); }
-    buf[7] = computeSimpleCRC(buf, buflen); // CRC computation should never fail here.
-    return(8);
+    encodeCommandBytes(buf + 3);
+    CC1PollAndCommandLayout::Ext::setDefault(buf);
+    CC1PollAndCommandLayout::Seq::set(buf, seq);
+    if(!includeCRC) { return(OTPROTOCOLCC_TRACE_RESULT(primary_frame_bytes)); }
+    return(OTPROTOCOLCC_TRACE_RESULT(appendFrameCRC(buf, buflen, primary_frame_bytes))); // CRC computation should never fail here.
     }
 
 // Decode from the wire, including CRC, into the current instance.
@@ -139,31 +342,32 @@ uint8_t CC1PollAndCommand::encodeSimple(uint8_t *const buf, const uint8_t buflen
 //     '?' hc1 hc2 1+rp lf|lt|lc 1 1 nzcrc
 uint8_t CC1PollAndCommand::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
     {
+    OTPROTOCOLCC_TRACE_DECODE(buf, buflen);
+    OTPROTOCOLCC_LATENCY_START(frame_type);
     forceInvalid(); // Invalid by default.
     // Validate args.
     if(!decodeSimpleArgsSane(buf, buflen, true)) { return(0); } // FAIL.
     // Check frame type.
     if(frame_type /* OTRadioLink::FTp2_CC1PollAndCommand */ != buf[0]) { return(0); } // FAIL.
-    // Explicitly test at least first extension byte is as expected.
-    if(1 != buf[5]) { return(0); } // FAIL.
-    // Check inbound values for validity.
-    const uint8_t _rp = buf[3] - 1;
-    if(_rp >= 101) { return(0); } // FAIL.
-    rp = _rp;
-    // Extract light values.
-    lc = buf[4] & 3;
-    lt = (buf[4] >> 2) & 0xf;
-    if(0 == lt) { return(0); } // FAIL.
-    lf = (buf[4] >> 6) & 3;
-    if(0 == lf) { return(0); } // FAIL.
+    // Check inbound values for validity, including extension byte and optional sequence number.
+    if(!CC1PollAndCommandLayout::Fields::isValid(buf)) { return(0); } // FAIL.
+    // Extract them.
+    rp = CC1PollAndCommandLayout::RP::get(buf);
+    lc = CC1PollAndCommandLayout::LC::get(buf);
+    lt = CC1PollAndCommandLayout::LT::get(buf);
+    lf = CC1PollAndCommandLayout::LF::get(buf);
+    seq = CC1PollAndCommandLayout::Seq::get(buf);
+    OTPROTOCOLCC_LATENCY_STAGE(stage_validate);
     // Check CRC.
-    if(computeSimpleCRC(buf, buflen) != buf[7]) { return(0); } // FAIL.
+    if(!checkFrameCRC(buf, buflen, primary_frame_bytes)) { return(0); } // FAIL.
+    OTPROTOCOLCC_LATENCY_STAGE(stage_crc);
     // Extract house code last, leaving object invalid if bad value forced abort above.
     hc1 = buf[1];
     hc2 = buf[2];
     // Instance will be valid if house code is.
     // Reads a fixed number of bytes when successful.
-    return(8);
+    OTPROTOCOLCC_LATENCY_STAGE(stage_materialise);
+    return(OTPROTOCOLCC_TRACE_RESULT(CC1FrameBytes<primary_frame_bytes>::total));
     }
 
 
@@ -196,26 +400,52 @@ CC1PollResponse CC1PollResponse::make(const uint8_t hc1, const uint8_t hc2,
     return(r);
     }
 
+// Encode all fields except the house code to the four wire bytes at buf.
+//     w|s|1+rh 1+tp 1+tr sy|al|0
+void CC1PollResponse::encodeBodyBytes(uint8_t *const buf) const
+    {
+    // Fields sharing a byte are set by read-modify-write, so clear first.
+    for(uint8_t i = 0; i < CC1PollResponseDelta::body_bytes; ++i) { buf[i] = 0; }
+    CC1PollResponseBodyLayout::RH::set(buf, rh);
+    CC1PollResponseBodyLayout::S::set(buf, s);
+    CC1PollResponseBodyLayout::W::set(buf, w);
+    CC1PollResponseBodyLayout::TP::set(buf, tp);
+    CC1PollResponseBodyLayout::TR::set(buf, tr);
+    CC1PollResponseBodyLayout::AL::set(buf, al);
+    CC1PollResponseBodyLayout::SY::set(buf, sy);
+    }
+
+// Decode and validate all fields except the house code from the four wire bytes at buf.
+// Returns false if any value is invalid.
+//     w|s|1+rh 1+tp 1+tr sy|al|0
+bool CC1PollResponse::decodeBodyBytes(const uint8_t *const buf)
+    {
+    // Check inbound values for validity.
+    if(!CC1PollResponseBodyLayout::Fields::isValid(buf)) { return(false); } // FAIL.
+    rh = CC1PollResponseBodyLayout::RH::get(buf);
+    s = (0 != CC1PollResponseBodyLayout::S::get(buf));
+    w = (0 != CC1PollResponseBodyLayout::W::get(buf));
+    tp = CC1PollResponseBodyLayout::TP::get(buf);
+    tr = CC1PollResponseBodyLayout::TR::get(buf);
+    al = CC1PollResponseBodyLayout::AL::get(buf);
+    sy = (0 != CC1PollResponseBodyLayout::SY::get(buf));
+    return(true);
+    }
+
 // Encode in simple form to the uint8_t array (no auth/enc).
 // Returns number of bytes written if successful,
 // 0 if not successful, eg because the buffer is too small.
 //     '*' hc1 hc2 w|s|1+rh 1+tp 1+tr sy|al|0 nzcrc
 uint8_t CC1PollResponse::encodeSimple(uint8_t *const buf, const uint8_t buflen, const bool includeCRC) const
     {
+    OTPROTOCOLCC_TRACE_ENCODE(frame_type, hc1, hc2);
     if(!encodeSimpleArgsSane(buf, buflen, includeCRC)) { return(0); } // FAIL.
     buf[0] = frame_type; // OTRadioLink::FTp2_CC1Alert;
     buf[1] = hc1;
     buf[2] = hc2;
-    buf[3] = rh + 1;
-    if(w) { buf[3] |= 0x80; }
-    if(s) { buf[3] |= 0x40; }
-    buf[4] = tp + 1;
-    buf[5] = tr + 1;
-    buf[6] = (al << 1);
-    if(sy) { buf[6] |= 0x80; }
-    if(!includeCRC) { return(7); }
-    buf[7] = computeSimpleCRC(buf, buflen); // CRC computation should never fail here.
-    return(8);
+    encodeBodyBytes(buf + 3);
+    if(!includeCRC) { return(OTPROTOCOLCC_TRACE_RESULT(primary_frame_bytes)); }
+    return(OTPROTOCOLCC_TRACE_RESULT(appendFrameCRC(buf, buflen, primary_frame_bytes))); // CRC computation should never fail here.
     }
 
 // Decode from the wire, including CRC, into the current instance.
@@ -224,41 +454,346 @@ uint8_t CC1PollResponse::encodeSimple(uint8_t *const buf, const uint8_t buflen,
 //     '*' hc1 hc2 w|s|1+rh 1+tp 1+tr sy|al|0 nzcrc
 uint8_t CC1PollResponse::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
     {
+    OTPROTOCOLCC_TRACE_DECODE(buf, buflen);
+    OTPROTOCOLCC_LATENCY_START(frame_type);
     forceInvalid(); // Invalid by default.
     // Validate args.
     if(!decodeSimpleArgsSane(buf, buflen, true)) { return(0); } // FAIL.
     // Check frame type.
     if(frame_type /* OTRadioLink::FTp2_CC1PollResponse */ != buf[0]) { return(0); } // FAIL.
 // TODO
-    // Check inbound values for validity.
-    // Extract RH%.
-    const uint8_t _rh = (buf[3] & 0x3f);
-    if((0 == _rh) || (_rh > 51)) { return(0); } // FAIL.
-    rh = _rh - 1;
-    w = (0 != (0x80 & buf[3]));
-    s = (0 != (0x40 & buf[3]));
-    const uint8_t _tp = buf[4] - 1;
-    if(_tp >= 200) { return(0); } // FAIL.
-    tp = _tp;
-    const uint8_t _tr = buf[5] - 1;
-    if(_tr >= 200) { return(0); } // FAIL.
-    tr = _tr;
-    const uint8_t _al = (buf[6] >> 1) & 0x3f;
-    if((0 == _al) || (0x3f == _al)) { return(0); } // FAIL.
-    al = _al;
-    sy = (0 != (0x80 & buf[6]));
+    // Check inbound values for validity and extract them.
+    if(!decodeBodyBytes(buf + 3)) { return(0); } // FAIL.
+    OTPROTOCOLCC_LATENCY_STAGE(stage_validate);
     // Check CRC.
-    if(computeSimpleCRC(buf, buflen) != buf[7]) { return(0); } // FAIL.
+    if(!checkFrameCRC(buf, buflen, primary_frame_bytes)) { return(0); } // FAIL.
+    OTPROTOCOLCC_LATENCY_STAGE(stage_crc);
     // Extract house code last, leaving object invalid if bad value forced abort above.
     hc1 = buf[1];
     hc2 = buf[2];
     // Instance will be valid if house code is.
     // Reads a fixed number of bytes when successful.
-    return(8);
+    OTPROTOCOLCC_LATENCY_STAGE(stage_materialise);
+    return(OTPROTOCOLCC_TRACE_RESULT(CC1FrameBytes<primary_frame_bytes>::total));
+    }
+
+
+// Tag from body bytes; in [1,14] so that tag|mask is never 0x00 nor 0xff.
+uint8_t CC1PollResponseDelta::tagForBody(const uint8_t *const body)
+    {
+    const uint8_t sum = body[0] + body[1] + body[2] + body[3];
+    return(1 + (sum % 14));
+    }
+
+// Tag identifying the base response body; in [1,14].
+uint8_t CC1PollResponseDelta::getTag(const CC1PollResponse &base)
+    {
+    uint8_t b[body_bytes];
+    base.encodeBodyBytes(b);
+    return(tagForBody(b));
     }
 
+// CRC over the full response as if sent with this frame type.
+uint8_t CC1PollResponseDelta::computeCRC(const uint8_t hc1, const uint8_t hc2, const uint8_t *const body)
+    {
+    const uint8_t full[CC1PollResponse::primary_frame_bytes] = { frame_type, hc1, hc2, body[0], body[1], body[2], body[3] };
+    return(CC1Base::computeCRC7(full, sizeof(full), sizeof(full)));
+    }
 
+// Rebuild a response from house code and four stored body bytes.
+// Returns false and leaves out invalid if the body is not valid.
+bool CC1PollResponseDelta::makeFromBody(const uint8_t hc1, const uint8_t hc2, const uint8_t *const body, CC1PollResponse &out)
+    {
+    CC1PollResponse r; // Invalid by default.
+    if(!r.decodeBodyBytes(body)) { out.forceInvalid(); return(false); } // FAIL.
+    r.hc1 = hc1;
+    r.hc2 = hc2;
+    out = r;
+    return(r.isValid());
+    }
 
+// Encode current as a delta against base.
+// Returns number of bytes written if successful, else 0.
+//     '+' hc1 hc2 tag|mask changed{0,3} nzcrc
+uint8_t CC1PollResponseDelta::encodeSimple(const CC1PollResponse &base, const CC1PollResponse &current,
+                                           uint8_t *const buf, const uint8_t buflen, const bool includeCRC)
+    {
+    if(!base.isValid() || !current.isValid()) { return(0); } // FAIL.
+    if((base.getHC1() != current.getHC1()) || (base.getHC2() != current.getHC2())) { return(0); } // FAIL.
+    uint8_t b[body_bytes];
+    base.encodeBodyBytes(b);
+    uint8_t c[body_bytes];
+    current.encodeBodyBytes(c);
+    uint8_t mask = 0;
+    uint8_t changed = 0;
+    for(uint8_t i = 0; i < body_bytes; ++i)
+        { if(b[i] != c[i]) { mask |= (1 << i); ++changed; } }
+    if(changed > max_changed_bytes) { return(0); } // FAIL: send full response.
+    const uint8_t len = min_frame_bytes + changed;
+    if((NULL == buf) || (buflen < (includeCRC ? len + 1 : len))) { return(0); } // FAIL.
+    buf[0] = frame_type;
+    buf[1] = current.getHC1();
+    buf[2] = current.getHC2();
+    buf[3] = (tagForBody(b) << 4) | mask;
+    uint8_t *p = buf + min_frame_bytes;
+    for(uint8_t i = 0; i < body_bytes; ++i)
+        { if(0 != (mask & (1 << i))) { *p++ = c[i]; } }
+    if(!includeCRC) { return(len); }
+    buf[len] = computeCRC(buf[1], buf[2], c);
+    return(len + 1);
+    }
+
+// Decode from the wire, including CRC, against the base held for the sending relay.
+// Returns number of bytes read, 0 if unsuccessful.
+//     '+' hc1 hc2 tag|mask changed{0,3} nzcrc
+uint8_t CC1PollResponseDelta::decodeSimple(const uint8_t *const buf, const uint8_t buflen,
+                                           const CC1PollResponse &base, CC1PollResponse &out)
+    {
+    out.forceInvalid(); // Invalid by default.
+    // Validate args.
+    if((NULL == buf) || (buflen < min_frame_bytes + 1)) { return(0); } // FAIL.
+    // Check frame type.
+    if(frame_type != buf[0]) { return(0); } // FAIL.
+    // Check base is for this relay and is the one the relay used.
+    if(!base.isValid() || (base.getHC1() != buf[1]) || (base.getHC2() != buf[2])) { return(0); } // FAIL.
+    uint8_t b[body_bytes];
+    base.encodeBodyBytes(b);
+    if((buf[3] >> 4) != tagForBody(b)) { return(0); } // FAIL.
+    // Check that all the changed bytes and the CRC are present.
+    const uint8_t mask = buf[3] & 0xf;
+    uint8_t changed = 0;
+    for(uint8_t i = 0; i < body_bytes; ++i) { if(0 != (mask & (1 << i))) { ++changed; } }
+    if(changed > max_changed_bytes) { return(0); } // FAIL.
+    const uint8_t len = min_frame_bytes + changed;
+    if(buflen < len + 1) { return(0); } // FAIL.
+    // Apply changes to base.
+    const uint8_t *p = buf + min_frame_bytes;
+    for(uint8_t i = 0; i < body_bytes; ++i)
+        { if(0 != (mask & (1 << i))) { b[i] = *p++; } }
+    // Check inbound values for validity and extract them.
+    CC1PollResponse r;
+    if(!r.decodeBodyBytes(b)) { return(0); } // FAIL.
+    // Check CRC over the reconstructed response.
+    if(computeCRC(buf[1], buf[2], b) != buf[len]) { return(0); } // FAIL.
+    // Extract house code last.
+    r.hc1 = buf[1];
+    r.hc2 = buf[2];
+    out = r;
+    // Reads a variable number of bytes when successful.
+    return(len + 1);
+    }
+
+// Note a poll addressed to this relay, before encoding the response to it.
+// A new sequence number shows that the hub holds the response to the previous one.
+void CC1PollResponseDeltaEncoder::onPoll(const CC1PollAndCommand &poll)
+    {
+    pollSeq = poll.getSeq();
+    if(sent.isValid() && (CC1Base::no_seq != sentSeq) && (CC1Base::no_seq != pollSeq) && (pollSeq != sentSeq))
+        {
+        base = sent;
+        sent.forceInvalid();
+        }
+    }
+
+// Encode the current response, including CRC, in full or compact form.
+// Returns number of bytes written if successful, else 0.
+uint8_t CC1PollResponseDeltaEncoder::encode(const CC1PollResponse &current, uint8_t *const buf, const uint8_t buflen)
+    {
+    uint8_t n = 0;
+    if(compactRemaining > 0)
+        {
+        n = CC1PollResponseDelta::encodeSimple(base, current, buf, buflen, true);
+        if(0 != n) { --compactRemaining; }
+        }
+    if(0 == n)
+        {
+        n = current.encodeSimple(buf, buflen, true);
+        if(0 == n) { return(0); } // FAIL.
+        compactRemaining = full_refresh_interval - 1;
+        }
+    // Becomes the base only once the hub acknowledges it.
+    sent = current;
+    sentSeq = pollSeq;
+    return(n);
+    }
+
+// Add a poll/command for one relay.
+// Returns false if the command is invalid, is for a relay already present, or there is no room.
+bool CC1MultiPollAndCommand::add(const CC1PollAndCommand &pac)
+    {
+    if(!pac.isValid()) { return(false); } // FAIL.
+    if(count >= max_entries) { return(false); } // FAIL.
+    if(find(pac.getHC1(), pac.getHC2()).isValid()) { return(false); } // FAIL: duplicate.
+    uint8_t *const e = entries[count];
+    e[0] = pac.getHC1();
+    e[1] = pac.getHC2();
+    pac.encodeCommandBytes(e + 2);
+    ++count;
+    return(true);
+    }
+
+// Get entry i, in order of addition; invalid if i is out of range.
+CC1PollAndCommand CC1MultiPollAndCommand::get(const uint8_t i) const
+    {
+    CC1PollAndCommand r; // Invalid by default.
+    if(i >= count) { return(r); } // FAIL.
+    const uint8_t *const e = entries[i];
+    // Values were validated on the way in.
+    r.decodeCommandBytes(e + 2);
+    r.seq = no_seq; // Not carried in aggregated form.
+    r.hc1 = e[0];
+    r.hc2 = e[1];
+    return(r);
+    }
+
+// Find the entry for the given relay.
+// Returns invalid instance if not present.
+CC1PollAndCommand CC1MultiPollAndCommand::find(const uint8_t hc1, const uint8_t hc2) const
+    {
+    for(uint8_t i = 0; i < count; ++i)
+        {
+        if((hc1 == entries[i][0]) && (hc2 == entries[i][1])) { return(get(i)); }
+        }
+    return(CC1PollAndCommand());
+    }
+
+// Encode in simple form to the uint8_t array (no auth/enc).
+// Returns number of bytes written if successful,
+// 0 if not successful, eg because the buffer is too small or there are no entries.
+//     '&' n (hc1 hc2 1+rp lf|lt|lc){n} crc16hi crc16lo
+uint8_t CC1MultiPollAndCommand::encodeSimple(uint8_t *const buf, const uint8_t buflen, const bool includeCRC) const
+    {
+    if(!isValid()) { return(0); } // FAIL.
+    const uint8_t len = getFrameBytes();
+    if(!encodeArgsSane(buf, buflen, len, includeCRC)) { return(0); } // FAIL.
+    buf[0] = frame_type;
+    buf[1] = count;
+    memcpy(buf + header_bytes, entries, count * entry_bytes);
+    if(!includeCRC) { return(len); }
+    return(appendFrameCRC(buf, buflen, len)); // CRC computation should never fail here.
+    }
+
+// Decode from the wire, including CRC, into the current instance.
+// Invalid parameters (eg 0xff house codes) will be rejected.
+// Returns number of bytes read, 0 if unsuccessful; also check isValid().
+//     '&' n (hc1 hc2 1+rp lf|lt|lc){n} crc16hi crc16lo
+uint8_t CC1MultiPollAndCommand::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
+    {
+    count = 0; // Invalid by default.
+    // Validate args, as far as the count.
+    if((NULL == buf) || (buflen < header_bytes)) { return(0); } // FAIL.
+    // Check frame type.
+    if(frame_type != buf[0]) { return(0); } // FAIL.
+    // Check count and that the whole frame is present.
+    const uint8_t n = buf[1];
+    if((0 == n) || (n > max_entries)) { return(0); } // FAIL.
+    const uint8_t len = header_bytes + (n * entry_bytes);
+    if(!decodeArgsSane(buf, buflen, len, true)) { return(0); } // FAIL.
+    // Check inbound values for validity.
+    for(uint8_t i = 0; i < n; ++i)
+        {
+        const uint8_t *const e = buf + header_bytes + (i * entry_bytes);
+        if((0xff == e[0]) || (0xff == e[1])) { return(0); } // FAIL.
+        CC1PollAndCommand c;
+        if(!c.decodeCommandBytes(e + 2)) { return(0); } // FAIL.
+        }
+    // Check CRC.
+    if(!checkFrameCRC(buf, buflen, len)) { return(0); } // FAIL.
+    // Copy entries last, leaving object invalid if bad value forced abort above.
+    memcpy(entries, buf + header_bytes, n * entry_bytes);
+    count = n;
+    // Reads a variable number of bytes when successful.
+    return(len + crcBytesForLength(len));
+    }
+
+
+// Factory method to create instance with no members.
+// Invalid parameters (except group ID) will be coerced into range.
+CC1GroupCommand CC1GroupCommand::make(const uint8_t gid,
+                                      const uint8_t rp,
+                                      const uint8_t lc, const uint8_t lt, const uint8_t lf)
+    {
+    CC1GroupCommand r;
+    r.gid = gid;
+    // Coerce and pack exactly as for an individual poll/command.
+    CC1PollAndCommand::make(0, 0, rp, lc, lt, lf).encodeCommandBytes(r.cmd);
+    return(r);
+    }
+
+// Bitmap bytes to send: up to and including the last non-zero one; 0 if no members.
+uint8_t CC1GroupCommand::getBitmapBytes() const
+    {
+    if(invalid_gid == gid) { return(0); } // FAIL.
+    for(uint8_t nb = max_bitmap_bytes; nb > 0; --nb)
+        { if(0 != bitmap[nb - 1]) { return(nb); } }
+    return(0);
+    }
+
+// Get the command as a CC1PollAndCommand addressed to the given relay.
+CC1PollAndCommand CC1GroupCommand::getCommandFor(const uint8_t hc1, const uint8_t hc2) const
+    {
+    CC1PollAndCommand r; // Invalid by default.
+    if(!isValid()) { return(r); } // FAIL.
+    // Values were validated on the way in.
+    r.decodeCommandBytes(cmd);
+    r.seq = no_seq; // Not carried in group form.
+    r.hc1 = hc1;
+    r.hc2 = hc2;
+    return(r);
+    }
+
+// Encode in simple form to the uint8_t array (no auth/enc).
+// Returns number of bytes written if successful,
+// 0 if not successful, eg because the buffer is too small or there are no members.
+//     '%' gid nb 1+rp lf|lt|lc bitmap{nb} crc
+uint8_t CC1GroupCommand::encodeSimple(uint8_t *const buf, const uint8_t buflen, const bool includeCRC) const
+    {
+    if(!isValid()) { return(0); } // FAIL.
+    const uint8_t nb = getBitmapBytes();
+    const uint8_t len = header_bytes + nb;
+    if(!encodeArgsSane(buf, buflen, len, includeCRC)) { return(0); } // FAIL.
+    buf[0] = frame_type;
+    buf[1] = gid;
+    buf[2] = nb;
+    buf[3] = cmd[0];
+    buf[4] = cmd[1];
+    memcpy(buf + header_bytes, bitmap, nb);
+    if(!includeCRC) { return(len); }
+    return(appendFrameCRC(buf, buflen, len)); // CRC computation should never fail here.
+    }
+
+// Decode from the wire, including CRC, into the current instance.
+// Returns number of bytes read, 0 if unsuccessful; also check isValid().
+//     '%' gid nb 1+rp lf|lt|lc bitmap{nb} crc
+uint8_t CC1GroupCommand::decodeSimple(const uint8_t *const buf, const uint8_t buflen)
+    {
+    gid = invalid_gid; // Invalid by default.
+    // Validate args, as far as nb.
+    if((NULL == buf) || (buflen < 3)) { return(0); } // FAIL.
+    // Check frame type.
+    if(frame_type != buf[0]) { return(0); } // FAIL.
+    if(invalid_gid == buf[1]) { return(0); } // FAIL.
+    // Check bitmap length and that the whole frame is present.
+    const uint8_t nb = buf[2];
+    if((0 == nb) || (nb > max_bitmap_bytes)) { return(0); } // FAIL.
+    const uint8_t len = header_bytes + nb;
+    if(!decodeArgsSane(buf, buflen, len, true)) { return(0); } // FAIL.
+    // Last bitmap byte sent must be non-zero, as on encode.
+    if(0 == buf[len - 1]) { return(0); } // FAIL.
+    // Check inbound values for validity.
+    CC1PollAndCommand c;
+    if(!c.decodeCommandBytes(buf + 3)) { return(0); } // FAIL.
+    // Check CRC.
+    if(!checkFrameCRC(buf, buflen, len)) { return(0); } // FAIL.
+    // Extract values, group ID last, leaving object invalid if bad value forced abort above.
+    cmd[0] = buf[3];
+    cmd[1] = buf[4];
+    memset(bitmap, 0, sizeof(bitmap));
+    memcpy(bitmap, buf + header_bytes, nb);
+    gid = buf[1];
+    // Reads a variable number of bytes when successful.
+    return(len + crcBytesForLength(len));
+    }
 
 
     }
@@ -28,6 +28,18 @@ Author(s) / Copyright (s): Damon Hart-Davis 2015
 
 #include <OTRadioLink.h>
 
+// Select the CRC7_5B kernel used by CC1Base::crc7Update(), and so by CC1Base::computeCRC7(),
+// CC1RelayRxFilter and CC1EncodedFrame, ie all CC1 CRC7 encoding and checking in this library
+// except CC1Base::verifyCRCBatch(), which uses the nibble table unless OTPROTOCOLCC_CRC7_CONSTANT_TIME is selected.
+// By default OTRadioLink::crc7_5B_update() is used, which branches on every data bit.
+// Uncomment (or define for the whole build) at most one of:
+//   * OTPROTOCOLCC_CRC7_NIBBLE_TABLE: two lookups per byte in a 16-byte flash table; fastest;
+//   * OTPROTOCOLCC_CRC7_CONSTANT_TIME: bitwise, with the polynomial applied under a mask rather than a branch,
+//     so time is independent of the data, and no table.
+// All give bit-identical results.
+//#define OTPROTOCOLCC_CRC7_NIBBLE_TABLE
+//#define OTPROTOCOLCC_CRC7_CONSTANT_TIME
+
 // Use namespaces to help avoid collisions.
 namespace OTProtocolCC
     {
@@ -47,6 +59,15 @@ namespace OTProtocolCC
     //        }
     //     }
 
+    // Frame types for CC1 extensions, not (yet) allocated in OTRadioLink::FrameType_V0p2_FS20.
+    // Chosen not to collide with the values there.
+    enum FrameType_CC1Ext
+        {
+        FTp2_CC1MultiPollAndCmd      = '&', // 0x26
+        FTp2_CC1PollResponseDelta    = '+', // 0x2b
+        FTp2_CC1GroupCmd             = '%', // 0x25
+        };
+
     // General byte-level format of the (CC1) hub/relay messages: type len HC1 HC2 body* crc7nz
     //
     // In part to be compatible with existing custom use of the FS20 carrier (but not encoding),
@@ -54,7 +75,8 @@ namespace OTProtocolCC
     //
     //  a) The first byte is one of '!', '?' or '*' to indicate the message type for the initial forms.
     //  b) (The first byte will later be one of '!', '?' or '*' ORed with '0x80' to indicate a secure message variant.)
-    //  c) Length is implicit/fixed and always 7 bytes excluding the trailing CRC.
+    //  c) Length is implicit/fixed and always 7 bytes excluding the trailing CRC for the initial forms.
+    //     (Later aggregated forms carry an entry count that fixes their length, and use a 16-bit CRC.)
     //  d) nn bytes of data follow, of which the first two bytes will be the house code.
     //  e) The 7-bit CRC follows, arranged to never be 0x00 or 0xff.
     //  f) For the secure forms the message type and length and the house code will be part of the authenticated data.
@@ -81,20 +103,34 @@ namespace OTProtocolCC
             // Anything other than 0xff can be considered valid.
             uint8_t hc1, hc2;
 
-            // Force instance to invalid state quickly.
-            void forceInvalid() { hc1 = 0xff; }
+            // Returns true if the arguments for encoding a frame of len bytes (excluding CRC) are sane.
+            static bool encodeArgsSane(uint8_t *buf, uint8_t buflen, uint8_t len, bool includeCRC)
+                { return((NULL != buf) && (buflen >= (includeCRC ? len + crcBytesForLength(len) : len))); }
+
+            // Returns true if the arguments for decoding a frame of len bytes (excluding CRC) are sane.
+            static bool decodeArgsSane(const uint8_t *buf, uint8_t buflen, uint8_t len, bool includeCRC)
+                { return((NULL != buf) && /* (0 != buf[0]) && */ (buflen >= (includeCRC ? len + crcBytesForLength(len) : len))); }
 
             // Returns true if the arguments for encodeSimple are sane.
-            // This in part relies on all CC1 messages being the same fixed length.
+            // This in part relies on all the initial CC1 messages being the same fixed length.
             static bool encodeSimpleArgsSane(uint8_t *buf, uint8_t buflen, bool includeCRC)
-                { return((NULL != buf) && (buflen >= (includeCRC ? 8 : 7))); }
+                { return(encodeArgsSane(buf, buflen, 7, includeCRC)); }
 
             // Returns true if the arguments for decodeSimple are sane.
-            // This in part relies on all CC1 messages being the same fixed length.
+            // This in part relies on all the initial CC1 messages being the same fixed length.
             static bool decodeSimpleArgsSane(const uint8_t *buf, uint8_t buflen, bool includeCRC)
-                { return((NULL != buf) && /* (0 != buf[0]) && */ (buflen >= (includeCRC ? 8 : 7))); }
+                { return(decodeArgsSane(buf, buflen, 7, includeCRC)); }
 
         public:
+            // Value for an absent (legacy) sequence number in messages that can carry one.
+            static const uint8_t no_seq = 0xff;
+            // Sequence numbers roll over in [0,seq_mask].
+            static const uint8_t seq_mask = 0x7f;
+
+            // Force instance to invalid state quickly.
+            // Public so that reused instances (eg decode targets) can be reset in place.
+            void forceInvalid() { hc1 = 0xff; }
+
             // True if the current state of this CC1 instance is valid.
             // By default false if house codes invalid (eg as achieved with forceInvalid()).
             virtual bool isValid() const { return(houseCodeIsValid()); }
@@ -126,20 +162,103 @@ namespace OTProtocolCC
             // Returns CRC on success,
             // else 0 (invalid) if the buffer is too short or the message otherwise invalid.
             static uint8_t computeSimpleCRC(const uint8_t *buf, uint8_t buflen);
+
+            // Compute the (non-zero) CRC7_5B as for computeSimpleCRC(), but over the first len bytes.
+            // The CRC7_5B is most effective at no more than max_crc7_frame_bytes.
+            // Returns CRC on success,
+            // else 0 (invalid) if the buffer is too short or the message otherwise invalid.
+            static uint8_t computeCRC7(const uint8_t *buf, uint8_t buflen, uint8_t len);
+
+            // Update a CRC7_5B with one byte, bit-exactly as OTRadioLink::crc7_5B_update(),
+            // with the kernel selected at compile time (see OTPROTOCOLCC_CRC7_NIBBLE_TABLE above).
+            // Any CRC7 computed outside computeCRC7() should use this rather than OTRadioLink directly.
+            static uint8_t crc7Update(uint8_t crc, uint8_t datum);
+
+            // Compute the (non-zero) 16-bit CRC for messages longer than CRC7_5B is good for.
+            // Uses CRC-16-CCITT (as crc16CCITTUpdate()) initialised to 0xffff over the first len bytes,
+            // which should detect all 3-bit errors in frames up to several kilobytes.
+            // A zero result is replaced with a non-zero value, as for computeSimpleCRC().
+            // Sent most-significant byte first after the body.
+            // Unlike CRC7 the trailing bytes are not whitened and may be 0x00 or 0xff.
+            // Returns CRC on success,
+            // else 0 (invalid) if the buffer is too short or the message otherwise invalid.
+            static uint16_t computeLongCRC(const uint8_t *buf, uint8_t buflen, uint8_t len);
+
+            // Update a CRC-16-CCITT with one byte, bit-exactly as avr-libc _crc_ccitt_update()
+            // (reflected polynomial 0x8408), but portable so that hosts (eg a hub) need not have avr-libc.
+            static inline uint16_t crc16CCITTUpdate(const uint16_t crc, uint8_t datum)
+                {
+                datum ^= (uint8_t)crc;
+                datum ^= (uint8_t)(datum << 4);
+                return((uint16_t)((((uint16_t)datum << 8) | (crc >> 8)) ^ (uint8_t)(datum >> 4) ^ ((uint16_t)datum << 3)));
+                }
+
+            // Longest frame (including leading type, excluding CRC) protected by a single CRC7_5B byte;
+            // longer frames are protected by the two-byte CRC from computeLongCRC().
+            static const uint8_t max_crc7_frame_bytes = 7;
+
+            // Number of trailing CRC bytes for a frame of len bytes including leading type but excluding CRC.
+            static inline uint8_t crcBytesForLength(const uint8_t len)
+                { return((len <= max_crc7_frame_bytes) ? 1 : 2); }
+
+            // Append the CRC appropriate to the frame length after the first len bytes.
+            // Returns len plus the number of CRC bytes on success,
+            // else 0 if the buffer is too short or the message otherwise invalid.
+            static uint8_t appendFrameCRC(uint8_t *buf, uint8_t buflen, uint8_t len);
+
+            // True iff the CRC appropriate to the frame length is present after the first len bytes and correct.
+            static bool checkFrameCRC(const uint8_t *buf, uint8_t buflen, uint8_t len);
+
+            // Verify the CRCs of n whole fixed-length (7 bytes plus CRC7) frames,
+            // each exactly as checkFrameCRC(frames[i], 8, 7) would, including rejecting a zero type byte.
+            // Intended as the first screening stage of a bulk scan, eg of logged frames.
+            // Uses the nibble table, or the constant-time kernel if OTPROTOCOLCC_CRC7_CONSTANT_TIME is selected.
+            // Sets bit (i & 7) of okMask[i >> 3] iff frame i passes, else clears it,
+            // so okMask must hold at least (n + 7) / 8 bytes.
+            // Returns the number of frames that passed.
+            static size_t verifyCRCBatch(const uint8_t (*frames)[8], size_t n, uint8_t *okMask);
+
+            // Get the length of a CC1 frame (including leading type, excluding CRC)
+            // from as much of its start as has been received,
+            // so that a receiver knows how many bytes to expect and where the CRC is before decoding.
+            // Returns 0 if the frame type is not known or more of the frame is needed to tell.
+            static uint8_t getFrameLength(const uint8_t *buf, uint8_t buflen);
+        };
+
+    // CC1FrameBytes
+    // Compile-time sizes for a CC1 frame of Len bytes including leading type but excluding CRC,
+    // with the CRC size chosen as by CC1Base::crcBytesForLength().
+    // For example to size a buffer for a whole frame:
+    //     uint8_t buf[CC1FrameBytes<CC1Alert::primary_frame_bytes>::total];
+    template<int Len>
+    struct CC1FrameBytes
+        {
+        enum
+            {
+            body = Len,
+            crc = (Len <= CC1Base::max_crc7_frame_bytes) ? 1 : 2,
+            total = Len + crc
+            };
         };
 
     // CC1Alert contains:
     //   * House code (hc1, hc2) of valve controller that the alert is being sent from (or on behalf of).
-    //   * Four extension bytes, currently reserved and of value 1.
+    //   * Four extension bytes, currently reserved and of value 1,
+    //     except that the second may optionally carry a rolling sequence number [0,127] as seq+2.
     // Fixed length on the wire, and protected by non-zero version of CRC7_5B.
     // Initial frame-type character is OTRadioLink::FTp2_CC1Alert.
     //     '!' hc1 hc2 1 1 1 1 nzcrc
+    //     '!' hc1 hc2 1 2+seq 1 1 nzcrc
+    // Decoders that predate sequence numbers check only the first extension byte so accept both forms.
     // Note that most values are whitened to be neither 0x00 nor 0xff on the wire.
     // Protocol note: sent asynchronously by the relay, though not generally at most once every 30s.
     // This message is simple enough that many of the methods can be inline.
     // This representation is immutable.
     class CC1Alert : public CC1Base
         {
+        private:
+            // Sequence number [0,127], or no_seq.
+            uint8_t seq;
         public:
             // Frame type (leading byte for simple encodings).
             static const OTRadioLink::FrameType_V0p2_FS20 frame_type = OTRadioLink::FTp2_CC1Alert;
@@ -147,11 +266,17 @@ namespace OTProtocolCC
             // The CRC7_5B is most effective at no more than 7 bytes.
             static const int primary_frame_bytes = 7;
             // Create known-invalid instance, quickly.
-            CC1Alert() { }
+            CC1Alert() : seq(no_seq) { }
+            // Get sequence number [0,127], or no_seq if absent.
+            inline uint8_t getSeq() const { return(seq); }
+            // True if a sequence number is present.
+            inline bool hasSeq() const { return(no_seq != seq); }
             // Factory method to create instance.
             // Invalid parameters (eg 0xff house codes) will be rejected.
+            //   * seq  optional rolling sequence number, taken modulo 128; no_seq (the default) for the legacy form
             // Returns instance; check isValid().
-            static inline CC1Alert make(uint8_t hc1, uint8_t hc2) { return(CC1Alert(hc1, hc2)); }
+            static inline CC1Alert make(uint8_t hc1, uint8_t hc2, uint8_t seq = no_seq)
+                { return(CC1Alert(hc1, hc2, (no_seq == seq) ? no_seq : (seq & seq_mask))); }
             // Encode to uint8_t buffer.
             virtual uint8_t encodeSimple(uint8_t *buf, uint8_t buflen, bool includeCRC) const;
             // Decode from the wire, including CRC, into the current instance.
@@ -159,7 +284,7 @@ namespace OTProtocolCC
             // Returns number of bytes read, 0 if unsuccessful; also check isValid().
             virtual uint8_t decodeSimple(const uint8_t *buf, uint8_t buflen);
         private:
-            CC1Alert(uint8_t _hc1, uint8_t _hc2) : CC1Base(_hc1, _hc2) { }
+            CC1Alert(uint8_t _hc1, uint8_t _hc2, uint8_t _seq) : CC1Base(_hc1, _hc2), seq(_seq) { }
         };
 
     // CC1PollAndCommand contains:
@@ -168,10 +293,13 @@ namespace OTProtocolCC
     //   * light-colour         [0,3] bit flags 1==red 2==green 0 => stop everything (lc)
     //   * light-on-time        [1,15] (0 not allowed) 30-450s in units of 30s (lt)
     //   * light-flash          [1,3] (0 not allowed) 1==single 2==double 3==on (lf)
-    //   * Two extension bytes, currently reserved and of value 1.
+    //   * Two extension bytes, currently reserved and of value 1,
+    //     except that the second may optionally carry a rolling sequence number [0,127] as seq+2.
     // Fixed length on the wire, and protected by non-zero version of CRC7_5B.
     // Initial frame-type character is OTRadioLink::FTp2_CC1PollAndCmd.
     //     '?' hc1 hc2 1+rp lf|lt|lc 1 1 nzcrc
+    //     '?' hc1 hc2 1+rp lf|lt|lc 1 2+seq nzcrc
+    // Decoders that predate sequence numbers check only the first extension byte so accept both forms.
     // Note that most values are whitened to be neither 0x00 nor 0xff on the wire.
     // Protocol note: sent asynchronously by the hub to the relay, at least every 15m, generally no more than once per 30s.
     // Protocol note: after ~30m without hearing one of these from its hub a relay may go into fallback mode.
@@ -183,6 +311,15 @@ namespace OTProtocolCC
             uint8_t lc; // :2;
             uint8_t lt; // :4;
             uint8_t lf; // :2;
+            uint8_t seq; // Sequence number [0,127], or no_seq.
+            // Encode rp/lc/lt/lf to the two wire bytes at buf: 1+rp lf|lt|lc
+            // Shared with aggregated forms so that all use the same packing.
+            void encodeCommandBytes(uint8_t *buf) const;
+            // Decode and validate rp/lc/lt/lf from the two wire bytes at buf.
+            // Returns false, leaving fields unchanged, if any value is invalid.
+            bool decodeCommandBytes(const uint8_t *buf);
+            friend class CC1MultiPollAndCommand;
+            friend class CC1GroupCommand;
         public:
             // Frame type (leading byte for simple encodings).
             static const OTRadioLink::FrameType_V0p2_FS20 frame_type = OTRadioLink::FTp2_CC1PollAndCmd;
@@ -190,12 +327,18 @@ namespace OTProtocolCC
             // The CRC7_5B is most effective at no more than 7 bytes.
             static const int primary_frame_bytes = 7;
             // Create known-invalid instance, quickly.
-            CC1PollAndCommand() { }
+            CC1PollAndCommand() : seq(no_seq) { }
             // Get attributes/parameters.
             inline uint8_t getRP() const { return(rp); }
             inline uint8_t getLC() const { return(lc); }
             inline uint8_t getLT() const { return(lt); }
             inline uint8_t getLF() const { return(lf); }
+            // Get sequence number [0,127], or no_seq if absent.
+            inline uint8_t getSeq() const { return(seq); }
+            // True if a sequence number is present.
+            inline bool hasSeq() const { return(no_seq != seq); }
+            // Get the command (rp/lc/lt/lf) packed as its two wire bytes, eg to store or compare compactly.
+            inline void getCommandBytes(uint8_t *const buf) const { encodeCommandBytes(buf); }
             // Factory method to create instance.
             // Invalid parameters (except house codes) will be coerced into range.
             //   * House code (hc1, hc2) of valve controller that the poll/command is being sent to.
@@ -203,10 +346,12 @@ namespace OTProtocolCC
             //   * light-colour         [0,3] bit flags 1==red 2==green 0 => stop everything (lc)
             //   * light-on-time        [1,15] (0 not allowed) 30-450s in units of 30s (lt)
             //   * light-flash          [1,3] (0 not allowed) 1==single 2==double 3==on (lf)
+            //   * seq  optional rolling sequence number, taken modulo 128; no_seq (the default) for the legacy form
             // Returns instance; check isValid().
             static CC1PollAndCommand make(uint8_t hc1, uint8_t hc2,
                                           uint8_t rp,
-                                          uint8_t lc, uint8_t lt, uint8_t lf);
+                                          uint8_t lc, uint8_t lt, uint8_t lf,
+                                          uint8_t seq = no_seq);
             // Encode to uint8_t buffer.
             virtual uint8_t encodeSimple(uint8_t *buf, uint8_t buflen, bool includeCRC) const;
             // Decode from the wire, including CRC, into the current instance.
@@ -240,6 +385,13 @@ namespace OTProtocolCC
             bool w;
             bool s;
             bool sy;
+            // Encode all fields except the house code to the four wire bytes at buf: w|s|1+rh 1+tp 1+tr sy|al|0
+            // Shared with the compact (delta) form so that both use the same packing.
+            void encodeBodyBytes(uint8_t *buf) const;
+            // Decode and validate all fields except the house code from the four wire bytes at buf.
+            // Returns false if any value is invalid, in which case some fields may have been altered.
+            bool decodeBodyBytes(const uint8_t *buf);
+            friend class CC1PollResponseDelta;
         public:
             // Frame type (leading byte for simple encodings).
             static const OTRadioLink::FrameType_V0p2_FS20 frame_type = OTRadioLink::FTp2_CC1PollResponse;
@@ -279,6 +431,289 @@ namespace OTProtocolCC
             virtual uint8_t decodeSimple(const uint8_t *buf, uint8_t buflen);
         };
 
+    // CC1PollResponseDelta is an optional compact form of CC1PollResponse,
+    // sending only the body bytes that differ from a base response that the hub already holds.
+    // Contains:
+    //   * House code (hc1, hc2) of valve controller that the response is from.
+    //   * A 4-bit tag in [1,14] derived from the base response body, so a mismatched base is quickly rejected.
+    //   * A 4-bit mask of which of the four CC1PollResponse body bytes (3 to 6) follow.
+    //   * The changed body bytes, in order, in exactly the CC1PollResponse wire form; at most max_changed_bytes.
+    // Variable length on the wire (5 to 8 bytes including CRC), and protected by non-zero version of CRC7_5B.
+    // The CRC is computed over the reconstructed full response as if sent with this frame type,
+    //     '+' hc1 hc2 w|s|1+rh 1+tp 1+tr sy|al|0
+    // so reconstruction against the wrong base is rejected just as a corrupted frame would be.
+    // Initial frame-type character is FTp2_CC1PollResponseDelta.
+    //     '+' hc1 hc2 tag|mask changed{0,3} nzcrc
+    // Note that the tag|mask byte is whitened to be neither 0x00 nor 0xff on the wire.
+    // Protocol note: sent by the relay in place of a CC1PollResponse only when few fields have changed,
+    // and with a full CC1PollResponse at least every few responses so that a lost base is soon repaired.
+    // There is no instance state: the methods convert between wire form and CC1PollResponse given the base.
+    class CC1PollResponseDelta
+        {
+        public:
+            // Frame type (leading byte for simple encodings).
+            static const uint8_t frame_type = FTp2_CC1PollResponseDelta;
+            // Number of CC1PollResponse body bytes that may be sent as a delta.
+            static const uint8_t body_bytes = 4;
+            // Maximum changed body bytes, keeping the frame within the 7 bytes that CRC7_5B is most effective for.
+            static const uint8_t max_changed_bytes = 3;
+            // Minimum and maximum length including leading type, but excluding trailing CRC.
+            static const int min_frame_bytes = 4;
+            static const int max_frame_bytes = min_frame_bytes + max_changed_bytes;
+            // Tag identifying the base response body; in [1,14].
+            static uint8_t getTag(const CC1PollResponse &base);
+            // Encode current as a delta against base.
+            // Returns number of bytes written if successful,
+            // 0 if not successful, eg because the buffer is too small,
+            // the house codes differ, or too many bytes have changed,
+            // in which case the full CC1PollResponse should be sent instead.
+            static uint8_t encodeSimple(const CC1PollResponse &base, const CC1PollResponse &current,
+                                        uint8_t *buf, uint8_t buflen, bool includeCRC);
+            // Decode from the wire, including CRC, against the base held for the sending relay.
+            // The house code to look up the base by is in buf[1] and buf[2], as for other CC1 messages.
+            // Returns number of bytes read, 0 if unsuccessful, eg if the base does not match;
+            // out is set to the reconstructed full response, else left invalid.
+            static uint8_t decodeSimple(const uint8_t *buf, uint8_t buflen,
+                                        const CC1PollResponse &base, CC1PollResponse &out);
+            // Extract the four body bytes from a valid response, eg to store compactly in a hub registry.
+            static void getBody(const CC1PollResponse &r, uint8_t *body) { r.encodeBodyBytes(body); }
+            // Rebuild a response from house code and four stored body bytes.
+            // Returns false and leaves out invalid if the body is not valid.
+            static bool makeFromBody(uint8_t hc1, uint8_t hc2, const uint8_t *body, CC1PollResponse &out);
+        private:
+            // CRC over the full response as if sent with this frame type.
+            static uint8_t computeCRC(uint8_t hc1, uint8_t hc2, const uint8_t *body);
+            // Tag from body bytes.
+            static uint8_t tagForBody(const uint8_t *body);
+        };
+
+    // CC1PollResponseDeltaEncoder
+    // Relay-side helper that chooses between full and compact poll responses.
+    // Uses as base the last response the hub acknowledged,
+    // so a lost response (full or compact) does not invalidate the responses that follow it.
+    // The hub acknowledges implicitly through poll sequence numbers:
+    // it repeats the sequence number of a poll that went unanswered, and uses a new one once it has a response.
+    // So a poll with a sequence number other than the one last answered shows the hub holds that answer.
+    // Polls without sequence numbers (legacy hubs) acknowledge nothing, so only full responses are sent.
+    // A full response is also sent at least every full_refresh_interval responses
+    // (or whenever the delta is too large), so that a hub that lost its state resynchronises soon.
+    class CC1PollResponseDeltaEncoder
+        {
+        private:
+            // Last response the hub acknowledged; invalid if none.
+            CC1PollResponse base;
+            // Last response sent and not yet acknowledged; invalid if none.
+            CC1PollResponse sent;
+            // Sequence number of the poll that sent answered, and of the latest poll; CC1Base::no_seq if none.
+            uint8_t sentSeq;
+            uint8_t pollSeq;
+            // Compact responses remaining before a full refresh is forced.
+            uint8_t compactRemaining;
+        public:
+            // Maximum responses between full responses, including the full response itself.
+            static const uint8_t full_refresh_interval = 4;
+            // Create with no base so that the first response will be full.
+            CC1PollResponseDeltaEncoder() : sentSeq(CC1Base::no_seq), pollSeq(CC1Base::no_seq), compactRemaining(0) { }
+            // Forget the base so that the next response is full, eg after a hub restart or house code change.
+            void reset() { base.forceInvalid(); sent.forceInvalid(); sentSeq = CC1Base::no_seq; pollSeq = CC1Base::no_seq; compactRemaining = 0; }
+            // Note a poll addressed to this relay, before encoding the response to it.
+            // Takes the last response sent as acknowledged if the poll shows the hub holds it.
+            void onPoll(const CC1PollAndCommand &poll);
+            // True if the last response sent has been acknowledged (or none is outstanding).
+            bool isAcknowledged() const { return(!sent.isValid()); }
+            // Encode the current response, including CRC, in full or compact form,
+            // as the answer to the last poll passed to onPoll().
+            // Returns number of bytes written if successful (8 for full, fewer for compact),
+            // 0 if not successful, eg because the response is invalid or the buffer too small.
+            uint8_t encode(const CC1PollResponse &current, uint8_t *buf, uint8_t buflen);
+        };
+
+    // CC1MultiPollAndCommand contains:
+    //   * Between 1 and max_entries poll/command entries, each for a different relay, each of:
+    //     * House code (hc1, hc2) of valve controller that the poll/command is being sent to.
+    //     * rp, lc, lt and lf exactly as for CC1PollAndCommand.
+    // Variable length on the wire, determined by the entry count n in the second byte,
+    // and protected by the CRC appropriate to that length from CC1Base::appendFrameCRC():
+    // the 16-bit CRC from computeLongCRC() for two or more entries,
+    // or the non-zero version of CRC7_5B for a single entry.
+    // Initial frame-type character is FTp2_CC1MultiPollAndCmd.
+    //     '&' n (hc1 hc2 1+rp lf|lt|lc){n} crc16hi crc16lo
+    //     '&' 1 hc1 hc2 1+rp lf|lt|lc nzcrc
+    // Each entry uses the same packing as CC1PollAndCommand bytes 1--4;
+    // the reserved extension bytes are not sent.
+    // Note that most values are whitened to be neither 0x00 nor 0xff on the wire, but not the CRC.
+    // Protocol note: for each addressed relay, equivalent to receiving the corresponding CC1PollAndCommand,
+    // so saves the preamble and framing per relay when the hub polls several at once.
+    // Entries are held in wire form to keep the instance small.
+    // Not immutable: entries are added one at a time after construction.
+    class CC1MultiPollAndCommand : public CC1Base
+        {
+        public:
+            // Frame type (leading byte for simple encodings).
+            static const uint8_t frame_type = FTp2_CC1MultiPollAndCmd;
+            // Maximum number of entries; bounded to keep the whole frame short.
+            static const uint8_t max_entries = 8;
+            // Bytes per entry on the wire.
+            static const uint8_t entry_bytes = 4;
+            // Bytes before the first entry: type and count.
+            static const uint8_t header_bytes = 2;
+            // Maximum length including leading type, but excluding trailing CRC.
+            static const int max_frame_bytes = header_bytes + (max_entries * entry_bytes);
+        private:
+            // Number of entries in use.
+            uint8_t count;
+            // Entries in wire form: hc1 hc2 1+rp lf|lt|lc
+            uint8_t entries[max_entries][entry_bytes];
+        public:
+            // Create empty (and thus invalid) instance.
+            CC1MultiPollAndCommand() : count(0) { }
+            // True if there is at least one entry.
+            virtual bool isValid() const { return(0 != count); }
+            // Number of entries.
+            uint8_t getCount() const { return(count); }
+            // Length of frame including leading type, but excluding trailing CRC.
+            uint8_t getFrameBytes() const { return(header_bytes + (count * entry_bytes)); }
+            // Add a poll/command for one relay.
+            // Returns false if the command is invalid, is for a relay already present, or there is no room.
+            bool add(const CC1PollAndCommand &pac);
+            // Get entry i, in order of addition; invalid if i is out of range.
+            CC1PollAndCommand get(uint8_t i) const;
+            // Find the entry for the given relay, as a relay would to pick out its own command.
+            // Returns invalid instance if not present.
+            CC1PollAndCommand find(uint8_t hc1, uint8_t hc2) const;
+            // Encode to uint8_t buffer.
+            // Fails if there are no entries.
+            virtual uint8_t encodeSimple(uint8_t *buf, uint8_t buflen, bool includeCRC) const;
+            // Decode from the wire, including CRC, into the current instance.
+            // Invalid parameters (eg 0xff house codes) will be rejected.
+            // Returns number of bytes read, 0 if unsuccessful; also check isValid().
+            virtual uint8_t decodeSimple(const uint8_t *buf, uint8_t buflen);
+        };
+
+    // CC1GroupCommand contains:
+    //   * Group ID [0,254] of the set of relays addressed, assigned by the hub (gid).
+    //   * Bitmap of members of the group addressed, by member index [0,63] within the group,
+    //     sent only as far as the last byte with a member bit set (nb bytes, [1,8]).
+    //   * rp, lc, lt and lf exactly as for CC1PollAndCommand, applied by every addressed relay.
+    // Variable length on the wire, determined by nb,
+    // and protected by the CRC appropriate to that length from CC1Base::appendFrameCRC():
+    // non-zero CRC7_5B for up to 16 members (nb <= 2), else the 16-bit CRC.
+    // Initial frame-type character is FTp2_CC1GroupCmd.
+    //     '%' gid nb 1+rp lf|lt|lc bitmap{nb} crc
+    // Bitmap byte i bit j (value 1<<j) addresses member index 8i+j.
+    // Note that nb and the command bytes are whitened to be neither 0x00 nor 0xff on the wire,
+    // but the gid (which may be 0x00), bitmap and CRC are not.
+    // Protocol note: sent by the hub to command many relays at once, eg a whole building;
+    // it does not count as a poll so each relay must still be polled individually.
+    // The relay-side membership test is a single bit lookup: see CC1GroupMembership.
+    class CC1GroupCommand : public CC1Base
+        {
+        public:
+            // Frame type (leading byte for simple encodings).
+            static const uint8_t frame_type = FTp2_CC1GroupCmd;
+            // Maximum members per group, and bitmap bytes to hold them.
+            static const uint8_t max_members = 64;
+            static const uint8_t max_bitmap_bytes = max_members / 8;
+            // Bytes before the bitmap: type, gid, nb and the two command bytes.
+            static const uint8_t header_bytes = 5;
+            // Maximum length including leading type, but excluding trailing CRC.
+            static const int max_frame_bytes = header_bytes + max_bitmap_bytes;
+            // Invalid group ID.
+            static const uint8_t invalid_gid = 0xff;
+        private:
+            // Group ID, invalid_gid if invalid.
+            uint8_t gid;
+            // Command in wire form: 1+rp lf|lt|lc
+            uint8_t cmd[2];
+            // Member bitmap, all max_bitmap_bytes held.
+            uint8_t bitmap[max_bitmap_bytes];
+            // Bitmap bytes to send: up to and including the last non-zero one; 0 if no members.
+            uint8_t getBitmapBytes() const;
+        public:
+            // Create known-invalid instance with no members.
+            CC1GroupCommand() : gid(invalid_gid)
+                {
+                cmd[0] = 0;
+                cmd[1] = 0;
+                for(uint8_t i = 0; i < max_bitmap_bytes; ++i) { bitmap[i] = 0; }
+                }
+            // Factory method to create instance with no members.
+            // Invalid parameters (except group ID) will be coerced into range as for CC1PollAndCommand::make().
+            // Returns instance; check isValid() once members are added.
+            static CC1GroupCommand make(uint8_t gid,
+                                        uint8_t rp,
+                                        uint8_t lc, uint8_t lt, uint8_t lf);
+            // True if the group ID is valid and there is at least one member.
+            virtual bool isValid() const { return((invalid_gid != gid) && (0 != getBitmapBytes())); }
+            // Get group ID.
+            uint8_t getGroupID() const { return(gid); }
+            // Add member by index within the group; returns false if index is out of range.
+            bool addMember(uint8_t index)
+                {
+                if(index >= max_members) { return(false); } // FAIL.
+                bitmap[index >> 3] |= (uint8_t)(1 << (index & 7));
+                return(true);
+                }
+            // True if the member index is addressed.
+            bool isMember(const uint8_t index) const
+                { return((index < max_members) && (0 != (bitmap[index >> 3] & (1 << (index & 7))))); }
+            // Get the command as a CC1PollAndCommand addressed to the given relay, as if sent to it alone.
+            CC1PollAndCommand getCommandFor(uint8_t hc1, uint8_t hc2) const;
+            // Length of frame including leading type, but excluding trailing CRC; 0 if no members.
+            uint8_t getFrameBytes() const { const uint8_t nb = getBitmapBytes(); return((0 == nb) ? 0 : header_bytes + nb); }
+            // Encode to uint8_t buffer.
+            // Fails if invalid.
+            virtual uint8_t encodeSimple(uint8_t *buf, uint8_t buflen, bool includeCRC) const;
+            // Decode from the wire, including CRC, into the current instance.
+            // Returns number of bytes read, 0 if unsuccessful; also check isValid().
+            virtual uint8_t decodeSimple(const uint8_t *buf, uint8_t buflen);
+        };
+
+    // CC1GroupMembership
+    // Relay-side membership of one group for CC1GroupCommand frames.
+    // The membership test needs only the first few bytes of the frame
+    // and no CRC work, so non-members can stop early;
+    // members should then decode fully (checking the CRC) before acting.
+    class CC1GroupMembership
+        {
+        private:
+            uint8_t gid;
+            uint8_t index;
+        public:
+            // Create membership of no group.
+            CC1GroupMembership() : gid(CC1GroupCommand::invalid_gid), index(0) { }
+            // Create membership of group gid as member index [0,63].
+            CC1GroupMembership(const uint8_t _gid, const uint8_t _index)
+              : gid((_index < CC1GroupCommand::max_members) ? _gid : CC1GroupCommand::invalid_gid), index(_index) { }
+            // True if a group is set.
+            bool isValid() const { return(CC1GroupCommand::invalid_gid != gid); }
+            uint8_t getGroupID() const { return(gid); }
+            uint8_t getIndex() const { return(index); }
+            // Number of leading bytes of a group command frame needed to tell if it addresses this member.
+            uint8_t getBytesNeeded() const { return(CC1GroupCommand::header_bytes + (index >> 3) + 1); }
+            // False if the first buflen bytes of a (possibly partial, possibly corrupt) frame
+            // already show that it is not a group command addressing this member, eg as bytes arrive.
+            // Reads at most getBytesNeeded() bytes; does not check the CRC.
+            bool mayMatchFrame(const uint8_t *const buf, const uint8_t buflen) const
+                {
+                if(!isValid() || (NULL == buf)) { return(false); }
+                const uint8_t byteIndex = index >> 3;
+                if((buflen > 0) && (CC1GroupCommand::frame_type != buf[0])) { return(false); }
+                if((buflen > 1) && (gid != buf[1])) { return(false); }
+                if((buflen > 2) && (buf[2] <= byteIndex)) { return(false); } // Bitmap too short.
+                if((buflen > CC1GroupCommand::header_bytes + byteIndex) &&
+                   (0 == (buf[CC1GroupCommand::header_bytes + byteIndex] & (1 << (index & 7))))) { return(false); }
+                return(true);
+                }
+            // True if the (possibly partial, possibly corrupt) frame is a group command addressing this member.
+            // Reads at most getBytesNeeded() bytes; does not check the CRC.
+            bool matchesFrame(const uint8_t *const buf, const uint8_t buflen) const
+                { return((buflen >= getBytesNeeded()) && mayMatchFrame(buf, buflen)); }
+            // True if the decoded group command addresses this member.
+            bool matches(const CC1GroupCommand &gc) const
+                { return(isValid() && gc.isValid() && (gid == gc.getGroupID()) && gc.isMember(index)); }
+        };
+
     }
 
 
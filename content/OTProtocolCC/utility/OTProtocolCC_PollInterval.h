@@ -0,0 +1,136 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Hub-side per-relay poll interval adapted to activity seen in poll responses.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_POLLINTERVAL_H
+#define ARDUINO_LIB_OTPROTOCOLCC_POLLINTERVAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_HouseCodeMap.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Poll interval state for one relay, from its last poll response.
+    // 8 bytes on AVR and common hosts (widest member first, so no padding).
+    struct CC1PollIntervalRecord
+        {
+        // Flag bits.
+        static const uint8_t f_seen = 1;
+        static const uint8_t f_s = 2;
+        static const uint8_t f_w = 4;
+        // When the last response was received (ms).
+        uint32_t lastAt;
+        // Current poll interval in seconds; 0 until the first response.
+        uint16_t intervalS;
+        // Room temperature (tr) from the last response.
+        uint8_t tr;
+        // Flag bits from the last response.
+        uint8_t flags;
+        CC1PollIntervalRecord() : lastAt(0), intervalS(0), tr(0), flags(0) { }
+        };
+
+    // CC1PollIntervalPolicy
+    // Hub-side choice of how often to poll each of up to N relays, within the protocol's 30s to 15 minutes:
+    // the interval drops straight to the minimum when a poll response shows activity
+    // (the switch toggle s flipped, the window w changed,
+    // or room temperature tr moved by tr_activity_delta or more at a rate of at least tr_activity_delta per min_interval_s),
+    // and doubles (up to the maximum) on each quiet response.
+    // So command latency is low in occupied rooms, and airtime falls while rooms are idle.
+    // The tr rate is over the time since the previous response,
+    // so normal drift between polls at long intervals does not count as activity.
+    // Relays not yet heard from are polled at the minimum interval.
+    // Plugs into CC1CommandDiffer as its keepalive, eg:
+    //     if(differ.needsTransmission(cmd, now, policy.getIntervalMs(cmd.getHC1(), cmd.getHC2()))) { ... }
+    template<uint16_t N>
+    class CC1PollIntervalPolicy
+        {
+        public:
+            // Bounds on the poll interval allowed by the protocol.
+            static const uint16_t min_interval_s = 30;
+            static const uint16_t max_interval_s = 15 * 60;
+            // Smallest change in tr (1/4 C units) counted as activity.
+            static const uint8_t tr_activity_delta = 2;
+        private:
+            CC1HouseCodeMap<CC1PollIntervalRecord, N> records;
+        public:
+            // Update from a poll response received at nowMs (from any free-running clock, eg millis(), which may wrap).
+            // Returns the relay's new interval in seconds, or 0 if the response is invalid or the registry is full.
+            uint16_t onResponse(const CC1PollResponse &r, const uint32_t nowMs)
+                {
+                if(!r.isValid()) { return(0); } // FAIL.
+                CC1PollIntervalRecord *const p = records.findOrInsert(r.getHC1(), r.getHC2());
+                if(NULL == p) { return(0); } // FAIL.
+                const uint8_t tr = r.getTR();
+                const uint8_t flags = CC1PollIntervalRecord::f_seen |
+                    (r.getS() ? CC1PollIntervalRecord::f_s : 0) | (r.getW() ? CC1PollIntervalRecord::f_w : 0);
+                const uint8_t dtr = (tr > p->tr) ? (tr - p->tr) : (p->tr - tr);
+                // tr moved fast enough: dtr / elapsed >= tr_activity_delta / min_interval, without overflow.
+                const uint32_t elapsedMs = nowMs - p->lastAt;
+                const bool trMoved = (dtr >= tr_activity_delta) &&
+                    (elapsedMs <= ((uint32_t)dtr * (1000UL * min_interval_s)) / tr_activity_delta);
+                // Nothing to compare the first response with, so start at the minimum.
+                const bool active = (0 == (p->flags & CC1PollIntervalRecord::f_seen)) ||
+                    (flags != p->flags) || trMoved;
+                if(active) { p->intervalS = min_interval_s; }
+                else { p->intervalS = (p->intervalS >= (max_interval_s / 2)) ? max_interval_s : (2 * p->intervalS); }
+                p->lastAt = nowMs;
+                p->tr = tr;
+                p->flags = flags;
+                return(p->intervalS);
+                }
+            // Get the current poll interval for the relay in seconds.
+            uint16_t getIntervalS(const uint8_t hc1, const uint8_t hc2) const
+                {
+                const CC1PollIntervalRecord *const p = records.find(hc1, hc2);
+                return((NULL == p) ? min_interval_s : p->intervalS);
+                }
+            // Get the current poll interval for the relay in ms, eg as a CC1CommandDiffer keepalive.
+            uint32_t getIntervalMs(const uint8_t hc1, const uint8_t hc2) const
+                { return(1000UL * getIntervalS(hc1, hc2)); }
+            // Iterate over relays (eg to snapshot them): for i in [0,capacity), get the record if any.
+            bool getRecord(const uint16_t i, uint8_t &hc1, uint8_t &hc2, const CC1PollIntervalRecord *&r) const
+                { return(records.getSlot(i, hc1, hc2, r)); }
+            // Restore a relay's record (eg from a snapshot), with times already on this clock.
+            // Returns false if the interval is out of range, the house code is invalid or the registry is full.
+            bool restore(const uint8_t hc1, const uint8_t hc2, const CC1PollIntervalRecord &r)
+                {
+                if((0 != r.intervalS) && ((r.intervalS < min_interval_s) || (r.intervalS > max_interval_s))) { return(false); } // FAIL.
+                CC1PollIntervalRecord *const p = records.findOrInsert(hc1, hc2);
+                if(NULL == p) { return(false); } // FAIL.
+                *p = r;
+                return(true);
+                }
+            // Maximum number of relays.
+            static const uint16_t capacity = N;
+            // Number of relays tracked.
+            uint16_t size() const { return(records.size()); }
+            // Forget all relays.
+            void clear() { records.clear(); }
+        };
+    }
+
+
+#endif
@@ -0,0 +1,111 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Hub-side registry of the last poll response heard from each relay.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_POLLRESPONSEREGISTRY_H
+#define ARDUINO_LIB_OTPROTOCOLCC_POLLRESPONSEREGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_HouseCodeMap.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Last response from one relay, packed as the four CC1PollResponse body bytes.
+    // A zero first byte marks no response yet, since that is never valid on the wire.
+    struct CC1PollResponseRecord
+        {
+        uint8_t body[CC1PollResponseDelta::body_bytes];
+        CC1PollResponseRecord() { body[0] = 0; }
+        bool isSet() const { return(0 != body[0]); }
+        };
+
+    // CC1PollResponseRegistry
+    // Hub-side store of the last poll response from each of up to N relays,
+    // 6 bytes per relay, used as the base to reconstruct compact CC1PollResponseDelta frames.
+    template<uint16_t N>
+    class CC1PollResponseRegistry
+        {
+        private:
+            CC1HouseCodeMap<CC1PollResponseRecord, N> records;
+        public:
+            // Decode a full ('*') or compact ('+') poll response from the wire, including CRC,
+            // and on success record it as the latest from that relay.
+            // Returns number of bytes read, 0 if unsuccessful, eg if there is no base for a compact frame;
+            // out is set to the full response, else left invalid.
+            // A full response is still returned if the registry is full, but is not recorded.
+            uint8_t decode(const uint8_t *const buf, const uint8_t buflen, CC1PollResponse &out)
+                {
+                out.forceInvalid();
+                if((NULL == buf) || (0 == buflen)) { return(0); } // FAIL.
+                uint8_t n = 0;
+                if(CC1PollResponse::frame_type == buf[0])
+                    { n = out.decodeSimple(buf, buflen); }
+                else if((CC1PollResponseDelta::frame_type == buf[0]) && (buflen >= 3))
+                    {
+                    CC1PollResponse base;
+                    if(!get(buf[1], buf[2], base)) { return(0); } // FAIL: no base.
+                    n = CC1PollResponseDelta::decodeSimple(buf, buflen, base, out);
+                    }
+                if((0 == n) || !out.isValid()) { out.forceInvalid(); return(0); } // FAIL.
+                CC1PollResponseRecord *const r = records.findOrInsert(out.getHC1(), out.getHC2());
+                if(NULL != r) { CC1PollResponseDelta::getBody(out, r->body); }
+                return(n);
+                }
+            // Get the last response from the given relay.
+            // Returns false and leaves out invalid if there is none.
+            bool get(const uint8_t hc1, const uint8_t hc2, CC1PollResponse &out) const
+                {
+                const CC1PollResponseRecord *const r = records.find(hc1, hc2);
+                if((NULL == r) || !r->isSet()) { out.forceInvalid(); return(false); } // FAIL.
+                return(CC1PollResponseDelta::makeFromBody(hc1, hc2, r->body, out));
+                }
+            // Iterate over stored responses: for i in [0,capacity), get house code and body bytes if set.
+            // Returns false for an unused slot (or i out of range).
+            bool getRecord(const uint16_t i, uint8_t &hc1, uint8_t &hc2, const CC1PollResponseRecord *&r) const
+                { return(records.getSlot(i, hc1, hc2, r) && r->isSet()); }
+            // Restore a stored response body (eg from a snapshot) for the given relay.
+            // Returns false if the body is not a valid response or the registry is full.
+            bool restore(const uint8_t hc1, const uint8_t hc2, const uint8_t *const body)
+                {
+                CC1PollResponse check;
+                if(!CC1PollResponseDelta::makeFromBody(hc1, hc2, body, check)) { return(false); } // FAIL.
+                CC1PollResponseRecord *const r = records.findOrInsert(hc1, hc2);
+                if(NULL == r) { return(false); } // FAIL.
+                for(uint8_t i = 0; i < CC1PollResponseDelta::body_bytes; ++i) { r->body[i] = body[i]; }
+                return(true);
+                }
+            // Maximum number of relays.
+            static const uint16_t capacity = N;
+            // Number of relays tracked.
+            uint16_t size() const { return(records.size()); }
+            // Forget all relays.
+            void clear() { records.clear(); }
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,221 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Relay-side receive support, including a path safe to run from the radio RX interrupt.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_RELAYRX_H
+#define ARDUINO_LIB_OTPROTOCOLCC_RELAYRX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <OTRadioLink.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_MessageTemplate.h"
+
+// Compiler barrier: stops the compiler moving (non-volatile) memory accesses across it.
+// Single-core AVR needs no hardware fence, only this.
+#define OTPROTOCOLCC_COMPILER_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1RelayRxFilter
+    // Quick classification of a raw received frame as a CC1PollAndCommand for a given relay,
+    // suitable for calling from an ISR:
+    //   * no virtual calls, no heap, no local arrays and no recursion;
+    //   * the only call is to the non-virtual CC1Base::crc7Update(), a fixed 6 times,
+    //     so stack use is the caller's frame plus a few bytes for that call (well under 16 bytes on AVR),
+    //     and timing follows the CRC7 kernel selected for the build (eg OTPROTOCOLCC_CRC7_CONSTANT_TIME);
+    //   * no loops with a data-dependent trip count,
+    //     so worst-case cycles are fixed (that of a matching frame, dominated by the 6 CRC updates);
+    //   * frames for other relays are rejected after examining at most 3 bytes, before any CRC work.
+    // Checks exactly what CC1PollAndCommand::decodeSimple() does, so a frame accepted here will decode.
+    class CC1RelayRxFilter
+        {
+        public:
+            // True iff buf holds a complete, valid CC1PollAndCommand (including CRC) addressed to hc1/hc2.
+            static inline bool isPollAndCommandFor(const uint8_t *const buf, const uint8_t buflen,
+                                                   const uint8_t hc1, const uint8_t hc2)
+                {
+                if((NULL == buf) || (buflen < CC1FrameBytes<CC1PollAndCommand::primary_frame_bytes>::total)) { return(false); }
+                // Cheapest and most selective tests first.
+                if((CC1PollAndCommand::frame_type != buf[0]) || (hc1 != buf[1]) || (hc2 != buf[2])) { return(false); }
+                if((0xff == hc1) || (0xff == hc2)) { return(false); } // Invalid house code never matches.
+                // Field validation as for CC1PollAndCommand::decodeSimple().
+                if(!CC1PollAndCommandLayout::Fields::isValid(buf)) { return(false); }
+                const uint8_t rp1 = buf[3];
+                const uint8_t l = buf[4];
+                const uint8_t s = buf[6];
+                // CRC as for CC1Base::computeSimpleCRC(), unrolled to avoid a loop.
+                uint8_t crc = buf[0];
+                crc = CC1Base::crc7Update(crc, buf[1]);
+                crc = CC1Base::crc7Update(crc, buf[2]);
+                crc = CC1Base::crc7Update(crc, rp1);
+                crc = CC1Base::crc7Update(crc, l);
+                crc = CC1Base::crc7Update(crc, 1);
+                crc = CC1Base::crc7Update(crc, s);
+                if(0 == crc) { crc = OTRadioLink::crc7_5B_update_nz_ALT; }
+                return(crc == buf[7]);
+                }
+        };
+
+    // CC1RelayAcceptanceFilter
+    // Early accept/reject of a frame from its first three bytes, before any CRC work,
+    // for a relay that can put its radio back to sleep as soon as it knows a frame is not for it.
+    // Can be applied as bytes arrive (eg from the radio FIFO), and is ISR-safe as for CC1RelayRxFilter.
+    // Accepts:
+    //   * CC1PollAndCommand ('?') addressed to this relay's house code;
+    //   * CC1MultiPollAndCommand ('&'), which may contain an entry for this relay anywhere;
+    //   * CC1GroupCommand ('%') for this relay's group, if one is set,
+    //     where this relay's member bit is set, as for CC1GroupMembership.
+    // Everything else (including all responses and alerts from other relays) is rejected.
+    // An accepted frame must still be fully decoded (or checked with CC1RelayRxFilter).
+    class CC1RelayAcceptanceFilter
+        {
+        public:
+            // Result of check().
+            enum { reject, need_more, accept };
+        private:
+            uint8_t hc1, hc2;
+            // Group membership; invalid if none.
+            CC1GroupMembership group;
+        public:
+            // Create filter accepting nothing until the house code is set.
+            CC1RelayAcceptanceFilter() : hc1(0xff), hc2(0xff) { }
+            // Set the house code of this relay.
+            void setHouseCode(const uint8_t _hc1, const uint8_t _hc2) { hc1 = _hc1; hc2 = _hc2; }
+            // Set (or with CC1GroupCommand::invalid_gid clear) group membership as member index [0,63].
+            // Returns false, leaving no group set, if the index is out of range.
+            bool setGroup(const uint8_t gid, const uint8_t index)
+                {
+                group = CC1GroupMembership(gid, index);
+                return((CC1GroupCommand::invalid_gid == gid) || group.isValid());
+                }
+
+            // Check the first len bytes received of a frame.
+            // Returns reject if the frame is certainly not for this relay, so the radio can sleep now,
+            // need_more if more bytes are needed to tell,
+            // or accept if the rest of the frame should be received and fully checked.
+            // Examines at most the first three bytes,
+            // except for group commands, which need up to CC1GroupMembership::getBytesNeeded().
+            uint8_t check(const uint8_t *const buf, const uint8_t len) const
+                {
+                if((NULL == buf) || (0 == len)) { return(need_more); }
+                if((0xff == hc1) || (0xff == hc2)) { return(reject); } // Not configured.
+                switch(buf[0])
+                    {
+                    case CC1PollAndCommand::frame_type:
+                        {
+                        if(len < 2) { return(need_more); }
+                        if(hc1 != buf[1]) { return(reject); }
+                        if(len < 3) { return(need_more); }
+                        return((hc2 == buf[2]) ? accept : reject);
+                        }
+                    case CC1MultiPollAndCommand::frame_type: { return(accept); }
+                    case CC1GroupCommand::frame_type:
+                        {
+                        if(!group.mayMatchFrame(buf, len)) { return(reject); }
+                        return((len < group.getBytesNeeded()) ? need_more : accept);
+                        }
+                    default: { return(reject); }
+                    }
+                }
+        };
+
+    // CC1RelayRxQueue
+    // Single-producer single-consumer queue of up to N raw CC1PollAndCommand frames
+    // for this relay, filled from the radio RX ISR and drained from the main loop,
+    // so that the MCU need not be woken from sleep for traffic addressed to other relays.
+    // The producer (offerFromISR) is ISR-safe as for CC1RelayRxFilter,
+    // plus a fixed-size 8-byte copy.
+    // The consumer side must not be called from an ISR.
+    // Set the house code before enabling the RX interrupt;
+    // changing it while frames may be arriving may misfilter one frame.
+    // N is in [1,254].
+    template<uint8_t N>
+    class CC1RelayRxQueue
+        {
+        private:
+            static const uint8_t frame_bytes = CC1FrameBytes<CC1PollAndCommand::primary_frame_bytes>::total;
+            // House code of this relay; 0xff (invalid) to accept nothing.
+            volatile uint8_t hc1, hc2;
+            // Index of next slot to write (producer) and read (consumer), in [0,N].
+            volatile uint8_t head, tail;
+            // Count of frames dropped because the queue was full.
+            volatile uint8_t dropped;
+            // Raw frames.
+            uint8_t frames[N + 1][frame_bytes];
+            static inline uint8_t nextIndex(const uint8_t i) { return((i >= N) ? 0 : (i + 1)); }
+        public:
+            // Create empty queue accepting nothing until the house code is set.
+            CC1RelayRxQueue() : hc1(0xff), hc2(0xff), head(0), tail(0), dropped(0) { }
+            // Set the house code of this relay.
+            void setHouseCode(const uint8_t _hc1, const uint8_t _hc2) { hc1 = _hc1; hc2 = _hc2; }
+            // Offer a raw received frame; call from the RX ISR (or anywhere else, from one context only).
+            // Returns true iff the frame was a valid poll/command for this relay and was queued,
+            // so the main loop should be woken.
+            bool offerFromISR(const uint8_t *const buf, const uint8_t buflen)
+                {
+                if(!CC1RelayRxFilter::isPollAndCommandFor(buf, buflen, hc1, hc2)) { return(false); }
+                const uint8_t h = head;
+                const uint8_t next = nextIndex(h);
+                if(next == tail) { if(0xff != dropped) { dropped = dropped + 1; } return(false); } // Full.
+                uint8_t *const f = frames[h];
+                f[0] = buf[0]; f[1] = buf[1]; f[2] = buf[2]; f[3] = buf[3];
+                f[4] = buf[4]; f[5] = buf[5]; f[6] = buf[6]; f[7] = buf[7];
+                // Publish only once the frame is complete; a single-byte store is atomic on AVR.
+                // The frame stores are not volatile so must be kept before the head store explicitly.
+                OTPROTOCOLCC_COMPILER_BARRIER();
+                head = next;
+                return(true);
+                }
+            // True if no frames are queued.
+            bool isEmpty() const { return(head == tail); }
+            // Get the count of frames dropped because the queue was full.
+            uint8_t getDropped() const { return(dropped); }
+            // Get the number of frames queued, in [0,N]; eg for CC1Metrics::setRxQueue().
+            uint8_t getDepth() const
+                {
+                const uint8_t h = head;
+                const uint8_t t = tail;
+                return((h >= t) ? (h - t) : (h + (N + 1) - t));
+                }
+            // Take the oldest queued frame and decode it into out.
+            // Returns false, leaving out untouched, if the queue is empty.
+            bool take(CC1PollAndCommand &out)
+                {
+                const uint8_t t = tail;
+                if(head == t) { return(false); }
+                // Read the frame only after seeing it published, and release the slot only once read.
+                OTPROTOCOLCC_COMPILER_BARRIER();
+                out.decodeSimple(frames[t], frame_bytes);
+                OTPROTOCOLCC_COMPILER_BARRIER();
+                tail = nextIndex(t);
+                return(true);
+                }
+        };
+
+    }
+
+
+#endif
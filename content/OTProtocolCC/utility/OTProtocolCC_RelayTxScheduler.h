@@ -0,0 +1,131 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Relay-side scheduling of poll responses and alerts to spread and batch transmissions.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_RELAYTXSCHEDULER_H
+#define ARDUINO_LIB_OTPROTOCOLCC_RELAYTXSCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1RelayTxScheduler
+    // Decides when a relay should transmit, given that a CC1PollResponse must be sent
+    // within 10s of the CC1PollAndCommand that asked for it, but need not be sent at once.
+    //   * The response goes in one of a fixed number of slots across the window,
+    //     chosen from the relay's house code so that relays polled close together
+    //     by the hub tend to answer at different times, plus random jitter within the slot
+    //     so that relays sharing a slot rarely collide twice running.
+    //     The end of the window is kept clear as a guard for airtime and clock error.
+    //   * A pending CC1Alert is held back to go out with a response due within alert_max_delay_ms,
+    //     else is due at once; whenever either is due both are sent, in one radio wakeup.
+    // Times are in ms from any free-running clock (eg millis()), and may wrap.
+    // The caller supplies the random jitter byte (eg from OTV0P2BASE::randRNG8())
+    // so that this has no dependency on a particular RNG.
+    class CC1RelayTxScheduler
+        {
+        public:
+            // Poll response window and the guard at its end.
+            static const uint16_t window_ms = 10000;
+            static const uint16_t guard_ms = 1000;
+            // Number and length of response slots.
+            static const uint8_t slots = 16;
+            static const uint16_t slot_ms = (window_ms - guard_ms) / slots;
+            // Longest an alert is held back to share a wakeup with a response.
+            static const uint16_t alert_max_delay_ms = 2000;
+            // Bits returned by due().
+            static const uint8_t send_response = 1;
+            static const uint8_t send_alert = 2;
+            // Returned by msUntilNext() when nothing is pending.
+            static const uint32_t never = 0xffffffffUL;
+
+        private:
+            uint8_t slot;
+            bool responsePending;
+            bool alertPending;
+            uint32_t responseDue;
+            uint32_t alertDue;
+
+            // True if time t has been reached at now, allowing for wrap.
+            static inline bool reached(const uint32_t now, const uint32_t t) { return((int32_t)(now - t) >= 0); }
+
+        public:
+            CC1RelayTxScheduler() : slot(0), responsePending(false), alertPending(false), responseDue(0), alertDue(0) { }
+
+            // Set the house code of this relay, which fixes its response slot.
+            void setHouseCode(const uint8_t hc1, const uint8_t hc2)
+                { slot = (uint8_t)(((uint16_t)(((uint16_t)hc1 << 8) | hc2) * 40503U) >> 12) % slots; }
+            // Get the response slot in [0,slots).
+            uint8_t getSlot() const { return(slot); }
+
+            // A poll/command for this relay was received at nowMs; schedule the response.
+            // jitter is a random byte spreading the response within its slot.
+            // A later poll before the response was sent replaces the earlier one.
+            void onPoll(const uint32_t nowMs, const uint8_t jitter)
+                {
+                responseDue = nowMs + (uint32_t)slot * slot_ms + (((uint32_t)jitter * slot_ms) >> 8);
+                responsePending = true;
+                // An alert waiting for longer than this response would take can now go with it.
+                if(alertPending && !reached(responseDue, alertDue)) { alertDue = responseDue; }
+                }
+
+            // An alert became pending at nowMs.
+            void onAlert(const uint32_t nowMs)
+                {
+                if(alertPending) { return; } // Already due no later than it would be now.
+                alertPending = true;
+                alertDue = (responsePending && reached(nowMs + alert_max_delay_ms, responseDue)) ? responseDue : nowMs;
+                }
+
+            // Returns what should be transmitted now, as send_response and/or send_alert bits,
+            // and treats it as sent; 0 if nothing is due.
+            uint8_t due(const uint32_t nowMs)
+                {
+                const bool any = (responsePending && reached(nowMs, responseDue)) ||
+                                 (alertPending && reached(nowMs, alertDue));
+                if(!any) { return(0); }
+                uint8_t r = 0;
+                if(responsePending) { r |= send_response; responsePending = false; }
+                if(alertPending) { r |= send_alert; alertPending = false; }
+                return(r);
+                }
+
+            // Time until something is due, so the relay can sleep until then; never if nothing is pending.
+            uint32_t msUntilNext(const uint32_t nowMs) const
+                {
+                uint32_t best = never;
+                if(responsePending) { best = reached(nowMs, responseDue) ? 0 : (responseDue - nowMs); }
+                if(alertPending)
+                    {
+                    const uint32_t a = reached(nowMs, alertDue) ? 0 : (alertDue - nowMs);
+                    if(a < best) { best = a; }
+                    }
+                return(best);
+                }
+        };
+
+    }
+
+
+#endif
@@ -0,0 +1,162 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Message-counter replay protection for secure CC1 frames.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_REPLAYPROTECTION_H
+#define ARDUINO_LIB_OTPROTOCOLCC_REPLAYPROTECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_HouseCodeMap.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1ReplayWindow
+    // Hub-side 64-entry sliding window over a relay's message counter.
+    // Accepts each counter value at most once, and accepts out-of-order arrivals
+    // no more than 63 behind the highest counter seen so far.
+    // All-zeros (as from the default constructor) is a valid initial state
+    // that will accept any counter.
+    // Small enough to hold in bulk in a CC1HouseCodeMap: 12 bytes on AVR,
+    // but 16 where uint64_t is 8-byte aligned (eg most 64-bit hosts).
+    class CC1ReplayWindow
+        {
+        private:
+            // Highest counter accepted so far.
+            uint32_t highest;
+            // Bit n set iff counter (highest - n) has been accepted.
+            uint64_t seen;
+        public:
+            // Window size in counter values.
+            static const uint8_t window_size = 64;
+            // Create window that will accept any counter.
+            CC1ReplayWindow() : highest(0), seen(0) { }
+            // Get the highest counter accepted so far; 0 if none.
+            uint32_t getHighest() const { return(highest); }
+            // True if ctr has not been seen and is not too old to be checked.
+            // Does not alter state, so may be used before authentication completes.
+            bool isFresh(const uint32_t ctr) const
+                {
+                if(ctr > highest) { return(true); }
+                const uint32_t d = highest - ctr;
+                return((d < window_size) && (0 == (seen & ((uint64_t)1 << d))));
+                }
+            // Check ctr and if fresh record it as seen in constant time.
+            // Returns true iff ctr was fresh, ie the frame is not a replay.
+            // Call only once the frame has been authenticated,
+            // else forged counters could be used to advance the window.
+            bool checkAndSet(const uint32_t ctr)
+                {
+                if(ctr > highest)
+                    {
+                    const uint32_t d = ctr - highest;
+                    seen = (d < window_size) ? ((seen << d) | 1) : 1;
+                    highest = ctr;
+                    return(true);
+                    }
+                const uint32_t d = highest - ctr;
+                if(d >= window_size) { return(false); } // FAIL: too old to tell.
+                const uint64_t bit = (uint64_t)1 << d;
+                const bool fresh = (0 == (seen & bit));
+                seen |= bit;
+                return(fresh);
+                }
+        };
+
+    // CC1ReplayRegistry
+    // Hub-side per-relay replay windows keyed by house code, for up to N relays.
+    // Windows are created on first contact with a relay.
+    template<uint16_t N>
+    class CC1ReplayRegistry
+        {
+        private:
+            CC1HouseCodeMap<CC1ReplayWindow, N> windows;
+        public:
+            // Check and record the counter for the (already authenticated) frame from the given relay.
+            // Returns true iff the frame is not a replay;
+            // also returns false if the house code is invalid or the registry is full.
+            bool checkAndSet(const uint8_t hc1, const uint8_t hc2, const uint32_t ctr)
+                {
+                CC1ReplayWindow *const w = windows.findOrInsert(hc1, hc2);
+                if(NULL == w) { return(false); } // FAIL.
+                return(w->checkAndSet(ctr));
+                }
+            // Get window for relay, or NULL if never seen.
+            const CC1ReplayWindow *find(const uint8_t hc1, const uint8_t hc2) const
+                { return(windows.find(hc1, hc2)); }
+            // Number of relays tracked.
+            uint16_t size() const { return(windows.size()); }
+            // Forget all relays, eg on hub key change.
+            void clear() { windows.clear(); }
+        };
+
+    // CC1TxCounter
+    // Relay-side monotonic message counter for secure frames,
+    // persisted in a way that needs only one (eg EEPROM) write per 2^epoch_shift messages
+    // plus one per restart.
+    // The persisted value is an epoch: counters below (epoch << epoch_shift) may already have been used.
+    // On restart counting resumes from the persisted epoch boundary,
+    // skipping any unused counters in the previous epoch, so a counter is never reused.
+    // Usage:
+    //     c.restore(readEpochFromEEPROM());
+    //     ...
+    //     if(c.needsPersist()) { writeEpochToEEPROM(c.getEpochToPersist()); c.epochPersisted(); }
+    //     if(!c.isExhausted()) { const uint32_t ctr = c.take(); ... }
+    class CC1TxCounter
+        {
+        private:
+            // Next counter value to use.
+            uint32_t next;
+            // Counters below (reserved << epoch_shift) are covered by the persisted epoch.
+            uint16_t reserved;
+        public:
+            // Each epoch covers 2^epoch_shift counter values.
+            static const uint8_t epoch_shift = 8;
+            // Create counter at zero with no reservation persisted.
+            CC1TxCounter() : next(0), reserved(0) { }
+            // Restore from the epoch last persisted; 0 (or erased EEPROM handled by the caller) for a fresh device.
+            void restore(const uint16_t persistedEpoch)
+                {
+                next = ((uint32_t)persistedEpoch) << epoch_shift;
+                reserved = persistedEpoch;
+                }
+            // True if a new epoch must be persisted before take() may be called.
+            bool needsPersist() const { return((next >> epoch_shift) >= reserved); }
+            // Epoch value to persist when needsPersist() is true.
+            uint16_t getEpochToPersist() const { return((uint16_t)((next >> epoch_shift) + 1)); }
+            // Call once getEpochToPersist() has been durably written.
+            void epochPersisted() { reserved = getEpochToPersist(); }
+            // True once all counter values have been used; the key must then be changed.
+            bool isExhausted() const { return((next >> epoch_shift) >= 0xffff); }
+            // Get the next counter value without using it.
+            uint32_t peek() const { return(next); }
+            // Use and return the next counter value.
+            // Only call when !needsPersist() && !isExhausted().
+            uint32_t take() { return(next++); }
+        };
+
+    }
+
+
+#endif
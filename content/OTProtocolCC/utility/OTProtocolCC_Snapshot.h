@@ -0,0 +1,342 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Crash-consistent snapshot of hub per-relay state to non-volatile storage, for fast restart.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_SNAPSHOT_H
+#define ARDUINO_LIB_OTPROTOCOLCC_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OTProtocolCC_OTProtocolCC.h"
+#include "OTProtocolCC_PollResponseRegistry.h"
+#include "OTProtocolCC_CommandDiffer.h"
+#include "OTProtocolCC_PollInterval.h"
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // Byte-addressed non-volatile storage, eg EEPROM, external flash or a file on a host hub.
+    // Each call returns false on failure.
+    class CC1SnapshotStore
+        {
+        public:
+            virtual bool read(uint16_t addr, uint8_t *buf, uint8_t len) = 0;
+            virtual bool write(uint16_t addr, const uint8_t *buf, uint8_t len) = 0;
+        };
+
+    // Snapshot formats, one per kind of hub table, each packing one relay's record as
+    //     hc1 hc2 data[record_bytes - 2]
+    // with a type tag (the second header byte) so that one table's snapshot is never loaded into another.
+    // Times are stored as ages (ms before nowMs at save) and restored relative to nowMs at load,
+    // since a free-running clock such as millis() restarts from 0 after a reset;
+    // time spent powered off is not counted.
+    // Each provides:
+    //     typedef ... table_t;
+    //     static const uint8_t tag, record_bytes;
+    //     static const uint16_t capacity;
+    //     static bool pack(const table_t &t, uint16_t i, uint8_t *r, uint32_t nowMs);    // False if slot i is unused.
+    //     static bool unpack(table_t &t, const uint8_t *r, uint32_t nowMs);            // False if not accepted.
+    struct CC1SnapshotFormatBase
+        {
+        // Store the age of time t at nowMs, little-endian.
+        static inline void putAge(uint8_t *const r, const uint32_t t, const uint32_t nowMs)
+            {
+            const uint32_t age = nowMs - t;
+            r[0] = (uint8_t)age; r[1] = (uint8_t)(age >> 8); r[2] = (uint8_t)(age >> 16); r[3] = (uint8_t)(age >> 24);
+            }
+        // Get back the time whose age is stored, relative to nowMs.
+        static inline uint32_t getTime(const uint8_t *const r, const uint32_t nowMs)
+            { return(nowMs - ((uint32_t)r[0] | ((uint32_t)r[1] << 8) | ((uint32_t)r[2] << 16) | ((uint32_t)r[3] << 24))); }
+        };
+
+    // CC1PollResponseRegistry<N>: hc1 hc2 body[4]
+    template<uint16_t N>
+    struct CC1RegistrySnapshotFormat : public CC1SnapshotFormatBase
+        {
+        typedef CC1PollResponseRegistry<N> table_t;
+        static const uint8_t tag = 'S';
+        static const uint8_t record_bytes = 2 + CC1PollResponseDelta::body_bytes;
+        static const uint16_t capacity = N;
+        static bool pack(const table_t &t, const uint16_t i, uint8_t *const r, uint32_t)
+            {
+            const CC1PollResponseRecord *rec;
+            if(!t.getRecord(i, r[0], r[1], rec)) { return(false); }
+            for(uint8_t j = 0; j < CC1PollResponseDelta::body_bytes; ++j) { r[2 + j] = rec->body[j]; }
+            return(true);
+            }
+        static bool unpack(table_t &t, const uint8_t *const r, uint32_t) { return(t.restore(r[0], r[1], r + 2)); }
+        };
+
+    // CC1CommandDiffer<N>: hc1 hc2 ackedAge(4) sentAge(4) acked[2] sent[2] retries
+    template<uint16_t N>
+    struct CC1CommandDifferSnapshotFormat : public CC1SnapshotFormatBase
+        {
+        typedef CC1CommandDiffer<N> table_t;
+        static const uint8_t tag = 'D';
+        static const uint8_t record_bytes = 15;
+        static const uint16_t capacity = N;
+        static bool pack(const table_t &t, const uint16_t i, uint8_t *const r, const uint32_t nowMs)
+            {
+            const CC1CommandRecord *rec;
+            if(!t.getRecord(i, r[0], r[1], rec)) { return(false); }
+            putAge(r + 2, rec->ackedAt, nowMs);
+            putAge(r + 6, rec->sentAt, nowMs);
+            r[10] = rec->acked[0]; r[11] = rec->acked[1];
+            r[12] = rec->sent[0]; r[13] = rec->sent[1];
+            r[14] = rec->retries;
+            return(true);
+            }
+        static bool unpack(table_t &t, const uint8_t *const r, const uint32_t nowMs)
+            {
+            CC1CommandRecord rec;
+            rec.ackedAt = getTime(r + 2, nowMs);
+            rec.sentAt = getTime(r + 6, nowMs);
+            rec.acked[0] = r[10]; rec.acked[1] = r[11];
+            rec.sent[0] = r[12]; rec.sent[1] = r[13];
+            rec.retries = r[14];
+            return(t.restore(r[0], r[1], rec));
+            }
+        };
+
+    // CC1PollIntervalPolicy<N>: hc1 hc2 lastAge(4) intervalS(2) tr flags
+    template<uint16_t N>
+    struct CC1PollIntervalSnapshotFormat : public CC1SnapshotFormatBase
+        {
+        typedef CC1PollIntervalPolicy<N> table_t;
+        static const uint8_t tag = 'P';
+        static const uint8_t record_bytes = 10;
+        static const uint16_t capacity = N;
+        static bool pack(const table_t &t, const uint16_t i, uint8_t *const r, const uint32_t nowMs)
+            {
+            const CC1PollIntervalRecord *rec;
+            if(!t.getRecord(i, r[0], r[1], rec)) { return(false); }
+            putAge(r + 2, rec->lastAt, nowMs);
+            r[6] = (uint8_t)rec->intervalS; r[7] = (uint8_t)(rec->intervalS >> 8);
+            r[8] = rec->tr;
+            r[9] = rec->flags;
+            return(true);
+            }
+        static bool unpack(table_t &t, const uint8_t *const r, const uint32_t nowMs)
+            {
+            CC1PollIntervalRecord rec;
+            rec.lastAt = getTime(r + 2, nowMs);
+            rec.intervalS = (uint16_t)r[6] | ((uint16_t)r[7] << 8);
+            rec.tr = r[8];
+            rec.flags = r[9];
+            return(t.restore(r[0], r[1], rec));
+            }
+        };
+
+    // CC1Snapshot
+    // Saves and restores a hub table as packed records in the given Format,
+    // so that a restarted hub resumes without re-polling every relay at once.
+    // Two slots (A/B) of slot_bytes each are used from base address upwards, alternately,
+    // each with a generation number and a CRC-16 over the whole slot written last,
+    // so a crash or power loss part way through a save leaves the previous snapshot intact:
+    //     'C' tag version generation(2) count(2) record{count} crc(2)
+    // (multi-byte values little-endian).
+    // Loading picks the valid slot with the later generation,
+    // restoring records as they are read and verifying the CRC at the end,
+    // so each record is read from the store once unless the latest slot turns out to be corrupt.
+    // Each table snapshotted needs its own region of the store.
+    template<class Format>
+    class CC1Snapshot
+        {
+        public:
+            typedef typename Format::table_t table_t;
+            static const uint8_t version = 1;
+            static const uint8_t header_bytes = 7;
+            static const uint8_t record_bytes = Format::record_bytes;
+            // Bytes per slot, and in total from the base address.
+            static const uint16_t slot_bytes = header_bytes + Format::capacity * record_bytes + 2;
+            static const uint16_t total_bytes = 2 * slot_bytes;
+
+        private:
+            CC1SnapshotStore &store;
+            const uint16_t base;
+            // Generation and slot of the last snapshot saved or loaded; lastSlot 0xff if unknown.
+            uint16_t generation;
+            uint8_t lastSlot;
+
+            uint16_t slotAddr(const uint8_t slot) const { return(base + ((0 == slot) ? 0 : slot_bytes)); }
+
+            static uint16_t crcBytes(uint16_t crc, const uint8_t *const buf, const uint8_t len)
+                {
+                for(uint8_t i = 0; i < len; ++i) { crc = CC1Base::crc16CCITTUpdate(crc, buf[i]); }
+                return(crc);
+                }
+
+            // Read a slot's header into h; returns false if it does not look like a snapshot.
+            bool readHeader(const uint8_t slot, uint8_t h[header_bytes], uint16_t &gen, uint16_t &count) const
+                {
+                if(!store.read(slotAddr(slot), h, header_bytes)) { return(false); } // FAIL.
+                if(('C' != h[0]) || (Format::tag != h[1]) || (version != h[2])) { return(false); } // FAIL.
+                gen = (uint16_t)h[3] | ((uint16_t)h[4] << 8);
+                count = (uint16_t)h[5] | ((uint16_t)h[6] << 8);
+                return(count <= Format::capacity);
+                }
+
+            // Read and verify a slot's header and CRC; returns false if the slot is not a valid snapshot.
+            // If into is not NULL each record is also restored into it as it is read,
+            // and false is returned if any record cannot be restored;
+            // the caller must clear it if false is returned.
+            bool checkSlot(const uint8_t slot, uint16_t &gen, uint16_t &count, table_t *const into, const uint32_t nowMs) const
+                {
+                uint8_t h[header_bytes];
+                if(!readHeader(slot, h, gen, count)) { return(false); } // FAIL.
+                const uint16_t a = slotAddr(slot);
+                uint16_t crc = crcBytes(0xffff, h, header_bytes);
+                uint8_t r[record_bytes];
+                for(uint16_t i = 0; i < count; ++i)
+                    {
+                    if(!store.read(a + header_bytes + i * record_bytes, r, record_bytes)) { return(false); } // FAIL.
+                    crc = crcBytes(crc, r, record_bytes);
+                    if((NULL != into) && !Format::unpack(*into, r, nowMs)) { return(false); } // FAIL.
+                    }
+                uint8_t c[2];
+                if(!store.read(a + header_bytes + count * record_bytes, c, 2)) { return(false); } // FAIL.
+                return(((uint8_t)(crc >> 8) == c[0]) && ((uint8_t)crc == c[1]));
+                }
+
+            // Order the slots by the generation in their headers, latest first, allowing for wrap.
+            // Returns the number of slots (0, 1 or 2) with a plausible header.
+            uint8_t orderSlots(uint8_t slots[2]) const
+                {
+                uint8_t h[header_bytes];
+                uint16_t g0 = 0, c0 = 0, g1 = 0, c1 = 0;
+                const bool v0 = readHeader(0, h, g0, c0);
+                const bool v1 = readHeader(1, h, g1, c1);
+                if(!v0 && !v1) { return(0); }
+                const bool first1 = v1 && (!v0 || ((int16_t)(g1 - g0) > 0));
+                slots[0] = first1 ? 1 : 0;
+                slots[1] = first1 ? 0 : 1;
+                return((v0 && v1) ? 2 : 1);
+                }
+
+            // Find the latest valid slot, or return false if there is none.
+            bool findLatest(uint8_t &slot, uint16_t &gen, uint16_t &count) const
+                {
+                uint8_t slots[2];
+                const uint8_t n = orderSlots(slots);
+                for(uint8_t i = 0; i < n; ++i)
+                    {
+                    if(checkSlot(slots[i], gen, count, NULL, 0)) { slot = slots[i]; return(true); }
+                    }
+                return(false);
+                }
+
+        public:
+            // Snapshot to the given store from base address upwards, total_bytes long.
+            CC1Snapshot(CC1SnapshotStore &_store, const uint16_t _base)
+              : store(_store), base(_base), generation(0), lastSlot(0xff) { }
+
+            // Generation of the last snapshot saved or loaded.
+            uint16_t getGeneration() const { return(generation); }
+
+            // Save the table into the slot not holding the latest snapshot,
+            // with times stored as ages at nowMs (from the same clock as the table's times).
+            // Returns false if a store write failed, in which case the previous snapshot remains loadable.
+            bool save(const table_t &table, const uint32_t nowMs = 0)
+                {
+                if(0xff == lastSlot)
+                    {
+                    uint16_t gen, count;
+                    uint8_t slot;
+                    if(findLatest(slot, gen, count)) { lastSlot = slot; generation = gen; }
+                    }
+                const uint8_t slot = (0 == lastSlot) ? 1 : 0;
+                const uint16_t gen = generation + 1;
+                uint8_t r[record_bytes];
+                // Count relays with a record.
+                uint16_t count = 0;
+                for(uint16_t i = 0; i < Format::capacity; ++i) { if(Format::pack(table, i, r, nowMs)) { ++count; } }
+                const uint16_t a = slotAddr(slot);
+                const uint8_t h[header_bytes] =
+                    { 'C', Format::tag, version, (uint8_t)gen, (uint8_t)(gen >> 8), (uint8_t)count, (uint8_t)(count >> 8) };
+                if(!store.write(a, h, header_bytes)) { return(false); } // FAIL.
+                uint16_t crc = crcBytes(0xffff, h, header_bytes);
+                uint16_t written = 0;
+                for(uint16_t i = 0; i < Format::capacity; ++i)
+                    {
+                    if(!Format::pack(table, i, r, nowMs)) { continue; }
+                    if(!store.write(a + header_bytes + written * record_bytes, r, record_bytes)) { return(false); } // FAIL.
+                    crc = crcBytes(crc, r, record_bytes);
+                    ++written;
+                    }
+                // CRC last: only now does this slot become the latest.
+                const uint8_t c[2] = { (uint8_t)(crc >> 8), (uint8_t)crc };
+                if(!store.write(a + header_bytes + written * record_bytes, c, 2)) { return(false); } // FAIL.
+                lastSlot = slot;
+                generation = gen;
+                return(true);
+                }
+
+            // Clear the table and load it from the latest valid snapshot,
+            // with times restored relative to nowMs (from the clock the table will be used with).
+            // A slot with a bad CRC or a record the table will not accept is skipped.
+            // Returns false (leaving the table empty) if there is no valid snapshot.
+            bool load(table_t &table, const uint32_t nowMs = 0)
+                {
+                uint8_t slots[2];
+                const uint8_t n = orderSlots(slots);
+                for(uint8_t i = 0; i < n; ++i)
+                    {
+                    table.clear();
+                    uint16_t gen, count;
+                    if(!checkSlot(slots[i], gen, count, &table, nowMs)) { continue; }
+                    lastSlot = slots[i];
+                    generation = gen;
+                    return(true);
+                    }
+                table.clear();
+                return(false); // FAIL.
+                }
+        };
+
+    // Snapshots of each hub table, eg CC1RegistrySnapshot<N> snap(store, base); snap.save(registry);
+    template<uint16_t N>
+    class CC1RegistrySnapshot : public CC1Snapshot<CC1RegistrySnapshotFormat<N> >
+        {
+        public:
+            CC1RegistrySnapshot(CC1SnapshotStore &_store, const uint16_t _base)
+              : CC1Snapshot<CC1RegistrySnapshotFormat<N> >(_store, _base) { }
+        };
+    template<uint16_t N>
+    class CC1CommandDifferSnapshot : public CC1Snapshot<CC1CommandDifferSnapshotFormat<N> >
+        {
+        public:
+            CC1CommandDifferSnapshot(CC1SnapshotStore &_store, const uint16_t _base)
+              : CC1Snapshot<CC1CommandDifferSnapshotFormat<N> >(_store, _base) { }
+        };
+    template<uint16_t N>
+    class CC1PollIntervalSnapshot : public CC1Snapshot<CC1PollIntervalSnapshotFormat<N> >
+        {
+        public:
+            CC1PollIntervalSnapshot(CC1SnapshotStore &_store, const uint16_t _base)
+              : CC1Snapshot<CC1PollIntervalSnapshotFormat<N> >(_store, _base) { }
+        };
+
+    }
+
+
+#endif
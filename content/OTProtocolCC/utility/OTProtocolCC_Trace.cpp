@@ -0,0 +1,181 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+#include "OTProtocolCC_Trace.h"
+
+#include <Arduino.h>
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+#include <util/atomic.h>
+#endif
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+// Print the CSV header line.
+void CC1Trace::printTextHeader(Print &p)
+    { p.println(F("start_us,duration_us,event,type,hc1,hc2,result")); }
+
+// Print one event as a CSV line.
+void CC1Trace::printText(const CC1TraceEvent &e, Print &p)
+    {
+    p.print(e.start); p.print(',');
+    p.print(e.duration); p.print(',');
+    p.print((char)e.event); p.print(',');
+    p.print(e.type); p.print(',');
+    p.print(e.hc1); p.print(',');
+    p.print(e.hc2); p.print(',');
+    p.println(e.result);
+    }
+
+// Convert a binary dump of len bytes to CSV as dumpText() would print.
+int CC1Trace::convertBinary(const uint8_t *const bin, const uint16_t len, Print &p)
+    {
+    if((NULL == bin) || (len < binary_header_bytes)) { return(-1); } // FAIL.
+    if(('C' != bin[0]) || ('C' != bin[1]) || ('1' != bin[2]) || ('T' != bin[3]) || (binary_version != bin[4])) { return(-1); } // FAIL.
+    const uint8_t n = bin[5];
+    if(len < binary_header_bytes + (uint16_t)n * binary_record_bytes) { return(-1); } // FAIL: truncated.
+    printTextHeader(p);
+    for(uint8_t i = 0; i < n; ++i)
+        {
+        const uint8_t *const r = bin + binary_header_bytes + (uint16_t)i * binary_record_bytes;
+        CC1TraceEvent e;
+        e.start = (uint32_t)r[0] | ((uint32_t)r[1] << 8) | ((uint32_t)r[2] << 16) | ((uint32_t)r[3] << 24);
+        e.duration = (uint16_t)r[4] | ((uint16_t)r[5] << 8);
+        e.event = r[6];
+        e.type = r[7];
+        e.hc1 = r[8];
+        e.hc2 = r[9];
+        e.result = r[10];
+        printText(e, p);
+        }
+    return(n);
+    }
+
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+
+// Ring of events; next is the slot to write next, count the number held.
+static CC1TraceEvent traceEvents[OTPROTOCOLCC_TRACE_EVENTS];
+static volatile uint8_t traceNext;
+static volatile uint8_t traceCount;
+// Non-zero while a dump is in progress, to stop the ring changing under it.
+static volatile uint8_t tracePaused;
+
+// Record an event; safe from ISR and main loop.
+void CC1Trace::record(const uint8_t event, const uint8_t type, const uint8_t hc1, const uint8_t hc2, const uint8_t result,
+                      const uint32_t start, const uint32_t end)
+    {
+    const uint32_t d = end - start;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+        if(tracePaused) { return; } // Dropped while dumping.
+        const uint8_t i = traceNext;
+        CC1TraceEvent &e = traceEvents[i];
+        e.start = start;
+        e.duration = (d > 0xffff) ? 0xffff : (uint16_t)d;
+        e.event = event;
+        e.type = type;
+        e.hc1 = hc1;
+        e.hc2 = hc2;
+        e.result = result;
+        traceNext = (i + 1 >= OTPROTOCOLCC_TRACE_EVENTS) ? 0 : (i + 1);
+        if(traceCount < OTPROTOCOLCC_TRACE_EVENTS) { traceCount = traceCount + 1; }
+        }
+    }
+
+// Number of events held.
+uint8_t CC1Trace::size() { return(traceCount); }
+
+// Get event i, 0 being the oldest held; false if out of range.
+bool CC1Trace::get(const uint8_t i, CC1TraceEvent &e)
+    {
+    bool ok = false;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+        const uint8_t n = traceCount;
+        if(i < n)
+            {
+            uint16_t j = (uint16_t)traceNext + OTPROTOCOLCC_TRACE_EVENTS - n + i;
+            if(j >= OTPROTOCOLCC_TRACE_EVENTS) { j -= OTPROTOCOLCC_TRACE_EVENTS; }
+            e = traceEvents[j];
+            ok = true;
+            }
+        }
+    return(ok);
+    }
+
+// Discard all events.
+void CC1Trace::clear()
+    {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { traceNext = 0; traceCount = 0; }
+    }
+
+// Write all held events in binary form.
+// Recording is paused for the dump so that the events written are a consistent snapshot,
+// with interrupts only briefly blocked per event; events from calls made meanwhile are dropped.
+void CC1Trace::dumpBinary(Print &p)
+    {
+    tracePaused = 1;
+    const uint8_t n = size();
+    const uint8_t h[binary_header_bytes] = { 'C', 'C', '1', 'T', binary_version, n };
+    p.write(h, sizeof(h));
+    for(uint8_t i = 0; i < n; ++i)
+        {
+        CC1TraceEvent e;
+        if(!get(i, e)) { e.start = 0; e.duration = 0; e.event = 0; e.type = 0; e.hc1 = 0xff; e.hc2 = 0xff; e.result = 0; }
+        const uint8_t r[binary_record_bytes] =
+            {
+            (uint8_t)e.start, (uint8_t)(e.start >> 8), (uint8_t)(e.start >> 16), (uint8_t)(e.start >> 24),
+            (uint8_t)e.duration, (uint8_t)(e.duration >> 8),
+            e.event, e.type, e.hc1, e.hc2, e.result
+            };
+        p.write(r, sizeof(r));
+        }
+    tracePaused = 0;
+    }
+
+// Write all held events as CSV, pausing recording as for dumpBinary().
+void CC1Trace::dumpText(Print &p)
+    {
+    tracePaused = 1;
+    printTextHeader(p);
+    const uint8_t n = size();
+    for(uint8_t i = 0; i < n; ++i)
+        {
+        CC1TraceEvent e;
+        if(get(i, e)) { printText(e, p); }
+        }
+    tracePaused = 0;
+    }
+
+CC1TraceScope::CC1TraceScope(const uint8_t _event, const uint8_t _type, const uint8_t _hc1, const uint8_t _hc2)
+  : start(micros()), event(_event), type(_type), hc1(_hc1), hc2(_hc2), result(0) { }
+
+CC1TraceScope::CC1TraceScope(const uint8_t _event, const uint8_t *const buf, const uint8_t buflen)
+  : start(micros()), event(_event),
+    type(((NULL != buf) && (buflen > 0)) ? buf[0] : 0),
+    hc1(((NULL != buf) && (buflen > 2)) ? buf[1] : 0xff),
+    hc2(((NULL != buf) && (buflen > 2)) ? buf[2] : 0xff),
+    result(0) { }
+
+CC1TraceScope::~CC1TraceScope()
+    { CC1Trace::record(event, type, hc1, hc2, result, start, micros()); }
+
+#endif
+
+    }
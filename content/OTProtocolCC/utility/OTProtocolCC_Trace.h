@@ -0,0 +1,142 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Optional compact tracing of CC1 encode/decode/CRC calls into a RAM ring buffer.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_TRACE_H
+#define ARDUINO_LIB_OTPROTOCOLCC_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Uncomment (or define for the whole build) to record trace events from the CC1 hot paths.
+// Costs OTPROTOCOLCC_TRACE_EVENTS * 11 bytes of RAM (12 on most hosts) and a few microseconds per traced call.
+// When not defined the hooks compile to nothing.
+//#define OTPROTOCOLCC_ENABLE_TRACE
+
+// Number of events retained; the oldest are overwritten first.
+#ifndef OTPROTOCOLCC_TRACE_EVENTS
+#define OTPROTOCOLCC_TRACE_EVENTS 16
+#endif
+
+class Print;
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // One trace event.
+    struct CC1TraceEvent
+        {
+        // micros() at the start of the call.
+        uint32_t start;
+        // Duration in microseconds, saturating at 0xffff.
+        uint16_t duration;
+        // What was traced (CC1Trace::ev_XXX).
+        uint8_t event;
+        // Frame type, and house code (0xff if unknown).
+        uint8_t type, hc1, hc2;
+        // Call result: bytes encoded/decoded or CRC value; 0 for failure.
+        uint8_t result;
+        };
+
+    // CC1Trace
+    // Fixed-size ring of the most recent trace events,
+    // so that latency outliers can be found in a live system
+    // without the cost of printing from the hot path.
+    // Recording is a few stores inside a short interrupt-disabled section,
+    // so events from an ISR and the main loop interleave safely.
+    // Dump with dumpBinary() (compact, for capture to a file) or dumpText() (CSV);
+    // convertBinary() turns a captured binary dump back into the same CSV,
+    // and can be built on a host to read trace files.
+    // Binary format: "CC1T", version byte (1), count byte, then count 11-byte records oldest first:
+    //     start(4, little-endian) duration(2, little-endian) event type hc1 hc2 result
+    class CC1Trace
+        {
+        public:
+            // Event kinds.
+            static const uint8_t ev_encode = 'E';
+            static const uint8_t ev_decode = 'D';
+            static const uint8_t ev_crc = 'C';
+            static const uint8_t binary_record_bytes = 11;
+            static const uint8_t binary_header_bytes = 6;
+            static const uint8_t binary_version = 1;
+
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+            // Record an event; safe from ISR and main loop.
+            static void record(uint8_t event, uint8_t type, uint8_t hc1, uint8_t hc2, uint8_t result,
+                               uint32_t start, uint32_t end);
+            // Number of events held, at most OTPROTOCOLCC_TRACE_EVENTS.
+            static uint8_t size();
+            // Get event i, 0 being the oldest held; false if out of range.
+            static bool get(uint8_t i, CC1TraceEvent &e);
+            // Discard all events.
+            static void clear();
+            // Write all held events in binary or CSV form.
+            // Recording is paused while writing so the output is a consistent snapshot,
+            // but events from traced calls made meanwhile (eg by an ISR) are dropped, not recorded.
+            static void dumpBinary(Print &p);
+            static void dumpText(Print &p);
+#endif
+            // Convert a binary dump of len bytes to CSV as dumpText() would print.
+            // Returns the number of records converted, or -1 if the header is bad.
+            // Available with tracing disabled, eg for a host-side converter.
+            static int convertBinary(const uint8_t *bin, uint16_t len, Print &p);
+            // Print the CSV header line.
+            static void printTextHeader(Print &p);
+            // Print one event as a CSV line.
+            static void printText(const CC1TraceEvent &e, Print &p);
+        };
+
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+    // Records one traced call when it goes out of scope.
+    class CC1TraceScope
+        {
+        private:
+            const uint32_t start;
+            const uint8_t event, type, hc1, hc2;
+            uint8_t result;
+        public:
+            CC1TraceScope(uint8_t _event, uint8_t _type, uint8_t _hc1, uint8_t _hc2);
+            CC1TraceScope(uint8_t _event, const uint8_t *buf, uint8_t buflen);
+            ~CC1TraceScope();
+            uint8_t setResult(const uint8_t r) { result = r; return(r); }
+        };
+#endif
+
+    }
+
+// Hooks for the hot paths.
+// Use at most one of the _ENCODE/_DECODE/_CRC scope hooks at the top of a function,
+// and wrap the successful return value with OTPROTOCOLCC_TRACE_RESULT(); other returns record a result of 0.
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+#define OTPROTOCOLCC_TRACE_ENCODE(type, hc1, hc2) OTProtocolCC::CC1TraceScope _cc1TraceScope(OTProtocolCC::CC1Trace::ev_encode, (type), (hc1), (hc2))
+#define OTPROTOCOLCC_TRACE_DECODE(buf, buflen) OTProtocolCC::CC1TraceScope _cc1TraceScope(OTProtocolCC::CC1Trace::ev_decode, (buf), (buflen))
+#define OTPROTOCOLCC_TRACE_CRC(buf, buflen) OTProtocolCC::CC1TraceScope _cc1TraceScope(OTProtocolCC::CC1Trace::ev_crc, (buf), (buflen))
+#define OTPROTOCOLCC_TRACE_RESULT(r) (_cc1TraceScope.setResult(r))
+#else
+#define OTPROTOCOLCC_TRACE_ENCODE(type, hc1, hc2)
+#define OTPROTOCOLCC_TRACE_DECODE(buf, buflen)
+#define OTPROTOCOLCC_TRACE_CRC(buf, buflen)
+#define OTPROTOCOLCC_TRACE_RESULT(r) (r)
+#endif
+
+
+#endif
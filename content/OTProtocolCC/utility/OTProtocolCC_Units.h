@@ -0,0 +1,104 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*
+ * Conversions between CC1PollResponse field units and fixed-point or float engineering units.
+ */
+
+#ifndef ARDUINO_LIB_OTPROTOCOLCC_UNITS_H
+#define ARDUINO_LIB_OTPROTOCOLCC_UNITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Use namespaces to help avoid collisions.
+namespace OTProtocolCC
+    {
+
+    // CC1Units
+    // Conversions for the CC1PollResponse fields (as returned by getTP(), getTR() and getRH()):
+    //   * tp: pipe temperature [0,199] in 1/2 C steps  <-> centi-degrees C [0,9950]
+    //   * tr: room temperature [0,199] in 1/4 C steps  <-> centi-degrees C [0,4975]
+    //   * rh: relative humidity [0,50] in 2% steps     <-> permille [0,1000]
+    // Conversions to field units round to nearest and clamp to the field range,
+    // so the result can be passed straight to CC1PollResponse::make().
+    // All scalar conversions are inline integer arithmetic (the float ones apart) with no tables.
+    // The batch forms convert a column of n values with a simple counted loop,
+    // suitable for export of many records at once (and auto-vectorisable by a host compiler);
+    // the fixed-point batch forms need no floating point, the float ones (to degrees C and %) do.
+    class CC1Units
+        {
+        public:
+            // Scalar, field to fixed point.
+            static inline uint16_t tpToCentiC(const uint8_t tp) { return((uint16_t)tp * 50U); }
+            static inline uint16_t trToCentiC(const uint8_t tr) { return((uint16_t)tr * 25U); }
+            static inline uint16_t rhToPermille(const uint8_t rh) { return((uint16_t)rh * 20U); }
+
+            // Scalar, fixed point to field, rounding and clamping.
+            static inline uint8_t centiCToTP(const uint16_t cC) { return((cC >= 9950U) ? 199 : (uint8_t)((cC + 25U) / 50U)); }
+            static inline uint8_t centiCToTR(const uint16_t cC) { return((cC >= 4975U) ? 199 : (uint8_t)((cC + 12U) / 25U)); }
+            static inline uint8_t permilleToRH(const uint16_t pm) { return((pm >= 1000U) ? 50 : (uint8_t)((pm + 10U) / 20U)); }
+
+            // Scalar, field to float (degrees C and %).
+            static inline float tpToC(const uint8_t tp) { return(tp * 0.5f); }
+            static inline float trToC(const uint8_t tr) { return(tr * 0.25f); }
+            static inline float rhToPercent(const uint8_t rh) { return(rh * 2.0f); }
+
+            // Scalar, float to field, rounding and clamping (NaN gives 0).
+            static inline uint8_t cToTP(const float c) { return(floatToField(c * 2.0f)); }
+            static inline uint8_t cToTR(const float c) { return(floatToField(c * 4.0f)); }
+            static inline uint8_t percentToRH(const float pc) { return((pc >= 100.0f) ? 50 : floatToField(pc * 0.5f)); }
+
+            // Batch, field to fixed point: out[i] = conversion of in[i] for i in [0,n).
+            static void tpToCentiC(const uint8_t *in, uint16_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = (uint16_t)in[i] * 50U; } }
+            static void trToCentiC(const uint8_t *in, uint16_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = (uint16_t)in[i] * 25U; } }
+            static void rhToPermille(const uint8_t *in, uint16_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = (uint16_t)in[i] * 20U; } }
+
+            // Batch, fixed point to field.
+            static void centiCToTP(const uint16_t *in, uint8_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = centiCToTP(in[i]); } }
+            static void centiCToTR(const uint16_t *in, uint8_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = centiCToTR(in[i]); } }
+            static void permilleToRH(const uint16_t *in, uint8_t *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = permilleToRH(in[i]); } }
+
+            // Batch, field to float.
+            static void tpToC(const uint8_t *in, float *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = in[i] * 0.5f; } }
+            static void trToC(const uint8_t *in, float *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = in[i] * 0.25f; } }
+            static void rhToPercent(const uint8_t *in, float *out, uint16_t n)
+                { for(uint16_t i = 0; i < n; ++i) { out[i] = in[i] * 2.0f; } }
+
+        private:
+            // Round non-negative v to nearest field value in [0,199]; negative and NaN give 0.
+            static inline uint8_t floatToField(const float v)
+                {
+                if(!(v > 0.0f)) { return(0); }
+                if(v >= 199.0f) { return(199); }
+                return((uint8_t)(v + 0.5f));
+                }
+        };
+
+    }
+
+
+#endif
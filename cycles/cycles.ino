@@ -0,0 +1,260 @@
+/*
+The OpenTRV project licenses this file to you
+under the Apache Licence, Version 2.0 (the "Licence");
+you may not use this file except in compliance
+with the Licence. You may obtain a copy of the Licence at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing,
+software distributed under the Licence is distributed on an
+"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+KIND, either express or implied. See the Licence for the
+specific language governing permissions and limitations
+under the Licence.
+
+Author(s) / Copyright (s): OpenTRV contributors 2026
+*/
+
+/*On-device cycle and stack cost of each codec path (ATmega328P only).
+ *
+ * Each path is run with interrupts off and Timer1 counting CPU cycles (no prescale),
+ * with the cost of an empty call subtracted; paths must complete in under 65536 cycles.
+ * Stack use is found by painting free RAM below the stack with a pattern before the call
+ * and finding the deepest byte overwritten, so includes the call itself.
+ * Each path is run several times (with varying input where that matters)
+ * and the min and max cycles reported.
+ *
+ * Output is parseable, one line per path:
+ *     path,<name>,<min cycles>,<max cycles>,<stack bytes>
+ * preceded by a line "cpu,<F_CPU>".
+ *
+ * Flash used by each path cannot be found at run time; get it from the linked ELF, eg:
+ *     avr-nm --size-sort -C -S cycles.cpp.elf | grep OTProtocolCC
+ *
+ * Timer1 is taken over, so PWM on pins 9 and 10 is unavailable while this runs.
+ */
+
+#if !defined(__AVR_ATmega328P__)
+#error This sketch measures ATmega328P cycles and stack directly.
+#endif
+
+#include <avr/io.h>
+#include <util/atomic.h>
+
+// Include libraries that this depends on.
+#include <OTV0p2Base.h>
+#include <OTRadioLink.h>
+
+// Include the library under test.
+#include <OTProtocolCC.h>
+
+
+void setup()
+  {
+#ifdef ON_V0P2_BOARD
+  // initialize serial communications at 4800 bps for typical use with V0p2 board.
+  Serial.begin(4800);
+#else
+  // initialize serial communications at 9600 bps for typical use with (eg) Arduino UNO.
+  Serial.begin(9600);
+#endif
+  // Timer1 free-running at CPU clock, no interrupts.
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TIMSK1 = 0;
+  }
+
+
+// Runs per path.
+static const uint8_t runs = 8;
+// Pattern for stack painting.
+static const uint8_t paint = 0xa5;
+// Bytes left unpainted just below the stack pointer for measure()'s own use.
+static const uint8_t paint_margin = 8;
+
+extern uint8_t __heap_start;
+extern uint8_t *__brkval;
+
+// Shared state for the paths; static so that they take no arguments.
+static uint8_t frame[8];
+static uint8_t garbage[8];
+static OTProtocolCC::CC1Alert alert;
+static OTProtocolCC::CC1PollAndCommand pac;
+static OTProtocolCC::CC1PollResponse pr;
+static OTProtocolCC::CC1EncodedFrame encoded;
+static uint8_t multiFrame[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1MultiPollAndCommand::max_frame_bytes>::total];
+static uint8_t multiLen;
+static OTProtocolCC::CC1MultiPollAndCommand multi;
+static uint8_t groupFrame[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1GroupCommand::max_frame_bytes>::total];
+static uint8_t groupLen;
+static OTProtocolCC::CC1GroupCommand group;
+static uint8_t deltaFrame[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1PollResponseDelta::max_frame_bytes>::total];
+static uint8_t deltaLen;
+static const OTProtocolCC::CC1PollResponse deltaBase = OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false);
+typedef OTProtocolCC::CC1Message<OTProtocolCC::CC1PollResponseLayout> message_t;
+static message_t message;
+static OTProtocolCC::CC1DecodeCache<OTProtocolCC::CC1PollResponse, 4> cache;
+static volatile uint8_t sink;
+static uint8_t run;
+
+typedef void (*path_t)();
+
+static void pathEmpty() { }
+static void pathCRC() { sink = OTProtocolCC::CC1Base::computeSimpleCRC(frame, sizeof(frame)); }
+static void pathAlertEncode() { sink = OTProtocolCC::CC1Alert::make(10, 21).encodeSimple(frame, sizeof(frame), true); }
+static void pathAlertDecode() { sink = alert.decodeSimple(frame, sizeof(frame)); }
+static void pathPACEncode() { sink = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1).encodeSimple(frame, sizeof(frame), true); }
+static void pathPACDecode() { sink = pac.decodeSimple(frame, sizeof(frame)); }
+static void pathPREncode() { sink = OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false).encodeSimple(frame, sizeof(frame), true); }
+static void pathPRDecode() { sink = pr.decodeSimple(frame, sizeof(frame)); }
+static void pathRelayFilter() { sink = OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(frame, sizeof(frame), 10, 21); }
+static void pathPatchTR() { sink = encoded.setTR(run); }
+static void pathGarbageDecode() { sink = pr.decodeSimple(garbage, sizeof(garbage)); }
+// Multi-poll for 4 relays and group command spanning 6 bitmap bytes, both so with the 16-bit CRC.
+static void pathMultiEncode()
+  {
+  OTProtocolCC::CC1MultiPollAndCommand m;
+  for(uint8_t r = 0; r < 4; ++r) { m.add(OTProtocolCC::CC1PollAndCommand::make(10, 21 + r, 50, 2, 3, 1)); }
+  sink = multiLen = m.encodeSimple(multiFrame, sizeof(multiFrame), true);
+  }
+static void pathMultiDecode() { sink = multi.decodeSimple(multiFrame, multiLen); }
+static void pathGroupEncode()
+  {
+  OTProtocolCC::CC1GroupCommand g = OTProtocolCC::CC1GroupCommand::make(7, 50, 2, 3, 1);
+  g.addMember(3);
+  g.addMember(40);
+  sink = groupLen = g.encodeSimple(groupFrame, sizeof(groupFrame), true);
+  }
+static void pathGroupDecode() { sink = group.decodeSimple(groupFrame, groupLen); }
+// Delta with one changed byte against deltaBase.
+static void pathDeltaEncode()
+  {
+  const OTProtocolCC::CC1PollResponse current = OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 81 + run, 30, false, false, false);
+  sink = deltaLen = OTProtocolCC::CC1PollResponseDelta::encodeSimple(deltaBase, current, deltaFrame, sizeof(deltaFrame), true);
+  }
+static void pathDeltaDecode() { sink = OTProtocolCC::CC1PollResponseDelta::decodeSimple(deltaFrame, deltaLen, deltaBase, pr); }
+static void pathMessageEncode() { sink = message_t::make(10, 21).encodeSimple(frame, sizeof(frame), true); }
+static void pathMessageDecode() { sink = message.decodeSimple(frame, sizeof(frame)); }
+static void pathCacheDecode() { sink = cache.decode(pr, frame, sizeof(frame)); }
+
+// Cycles for one call of p with interrupts off.
+static uint16_t cyclesFor(const path_t p)
+  {
+  uint16_t c;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+    TCNT1 = 0;
+    p();
+    c = TCNT1;
+    }
+  return(c);
+  }
+
+// Bytes of stack used by one call of p, with interrupts off so that no ISR frame is counted.
+static uint16_t stackFor(const path_t p)
+  {
+  uint16_t used = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+    uint8_t *const lo = (0 == __brkval) ? &__heap_start : __brkval;
+    uint8_t *const top = (uint8_t *)SP - paint_margin;
+    for(uint8_t *q = lo; q < top; ++q) { *q = paint; }
+    p();
+    uint8_t *q = lo;
+    while((q < top) && (paint == *q)) { ++q; }
+    used = (uint16_t)(top - q) + paint_margin;
+    }
+  return(used);
+  }
+
+// Measure and report one path; prep (if not NULL) is run before each run to set up input.
+static void measure(const __FlashStringHelper *const name, const path_t p, const path_t prep)
+  {
+  const uint16_t overhead = cyclesFor(pathEmpty);
+  const uint16_t baseStack = stackFor(pathEmpty);
+  uint16_t minC = 0xffff, maxC = 0;
+  for(run = 0; run < runs; ++run)
+    {
+    if(NULL != prep) { prep(); }
+    const uint16_t t = cyclesFor(p);
+    // Clamp rather than wrap if a path ever measures cheaper than the empty call.
+    const uint16_t c = (t > overhead) ? (t - overhead) : 0;
+    if(c < minC) { minC = c; }
+    if(c > maxC) { maxC = c; }
+    }
+  if(NULL != prep) { prep(); }
+  const uint16_t s = stackFor(p);
+  Serial.print(F("path,"));
+  Serial.print(name);
+  Serial.print(',');
+  Serial.print(minC);
+  Serial.print(',');
+  Serial.print(maxC);
+  Serial.print(',');
+  Serial.println((s > baseStack) ? (s - baseStack) : 0);
+  }
+
+// Input preparation.
+static void prepAlertFrame() { OTProtocolCC::CC1Alert::make(10, 21).encodeSimple(frame, sizeof(frame), true); }
+static void prepPACFrame() { OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1).encodeSimple(frame, sizeof(frame), true); }
+static void prepPRFrame() { OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false).encodeSimple(frame, sizeof(frame), true); }
+static void prepEncoded() { encoded.set(OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false)); }
+static void prepGarbage()
+  {
+  for(uint8_t i = 0; i < sizeof(garbage); ++i) { garbage[i] = OTV0P2BASE::randRNG8(); }
+  garbage[0] = OTProtocolCC::CC1PollResponse::frame_type;
+  }
+static void prepMultiFrame() { pathMultiEncode(); }
+static void prepGroupFrame() { pathGroupEncode(); }
+static void prepDeltaFrame() { pathDeltaEncode(); }
+// Cache primed with the frame so that the decode hits, or emptied so that it misses.
+static void prepCacheHit() { prepPRFrame(); cache.clear(); sink = cache.decode(pr, frame, sizeof(frame)); }
+static void prepCacheMiss() { prepPRFrame(); cache.clear(); }
+
+
+// Each round measures every path once.
+void loop()
+  {
+  static int loopCount = 0;
+
+  // Allow the terminal console to be brought up.
+  for(int i = 3; i > 0; --i)
+    {
+    Serial.print(F("Cycle counts starting... "));
+    Serial.print(i);
+    Serial.println();
+    delay(1000);
+    }
+  Serial.println();
+
+  Serial.print(F("cpu,"));
+  Serial.println(F_CPU);
+  measure(F("crc"), pathCRC, prepPRFrame);
+  measure(F("alert_encode"), pathAlertEncode, NULL);
+  measure(F("alert_decode"), pathAlertDecode, prepAlertFrame);
+  measure(F("pac_encode"), pathPACEncode, NULL);
+  measure(F("pac_decode"), pathPACDecode, prepPACFrame);
+  measure(F("pr_encode"), pathPREncode, NULL);
+  measure(F("pr_decode"), pathPRDecode, prepPRFrame);
+  measure(F("relay_filter"), pathRelayFilter, prepPACFrame);
+  measure(F("patch_tr"), pathPatchTR, prepEncoded);
+  measure(F("garbage_decode"), pathGarbageDecode, prepGarbage);
+  measure(F("multi_encode"), pathMultiEncode, NULL);
+  measure(F("multi_decode"), pathMultiDecode, prepMultiFrame);
+  measure(F("group_encode"), pathGroupEncode, NULL);
+  measure(F("group_decode"), pathGroupDecode, prepGroupFrame);
+  measure(F("delta_encode"), pathDeltaEncode, NULL);
+  measure(F("delta_decode"), pathDeltaDecode, prepDeltaFrame);
+  measure(F("message_encode"), pathMessageEncode, NULL);
+  measure(F("message_decode"), pathMessageDecode, prepPRFrame);
+  measure(F("cache_hit"), pathCacheDecode, prepCacheHit);
+  measure(F("cache_miss"), pathCacheDecode, prepCacheMiss);
+
+  Serial.print(F("%%% Cycle counts completed, round "));
+  Serial.print(++loopCount);
+  Serial.println();
+  Serial.println();
+  Serial.println();
+  delay(2000);
+  }
@@ -264,6 +264,1510 @@ static void testCC1PR()
   AssertIsTrue(!a2.isValid());
   }
 
+// Do some basic testing of the duty-cycle airtime accountant.
+static void testAirtime()
+  {
+  Serial.println("Airtime");
+  typedef OTProtocolCC::CC1AirtimeAccountant A;
+  A a; // 1%.
+  // 8-byte frame plus 8 bytes preamble/sync at 200us per bit.
+  AssertIsEqual(25600UL, a.airtimeUs(8));
+  AssertIsEqual(9000UL, a.getRateUsPerS());
+  // A burst drains the bucket and is then held back.
+  const uint32_t t0 = 0xfffff000UL; // Clock about to wrap.
+  uint16_t sent = 0;
+  while(a.tryCharge(t0, 8)) { ++sent; }
+  AssertIsEqual(A::default_burst_us / 25600, sent);
+  AssertIsEqual(1, a.getDenied());
+  AssertIsTrue(a.getHeadroomUs(t0) < 25600UL);
+  // Wait as advised and it can go.
+  const uint32_t wait = a.msUntilAvailable(t0, 8);
+  AssertIsTrue(wait > 0);
+  AssertIsTrue(wait <= 3000);
+  AssertIsTrue(!a.tryCharge(t0 + wait / 2, 8));
+  AssertIsEqual(0, a.msUntilAvailable(t0 + wait, 8));
+  AssertIsTrue(a.tryCharge(t0 + wait, 8));
+  // Refills to no more than the burst.
+  AssertIsEqual(A::default_burst_us, a.getHeadroomUs((uint32_t)(t0 + 3600000UL)));
+  // Greedy sending for 3 hours never exceeds 1% in any hour, but gets close.
+  A g;
+  // Frames sent in each of the last 60 minutes, and their sum, over a sliding hour.
+  uint16_t perMinute[60];
+  uint16_t hour = 0, maxHourFrames = 0;
+  for(int m = 0; m < 180; ++m)
+    {
+    uint16_t &slot = perMinute[m % 60];
+    if(m >= 60) { hour -= slot; }
+    slot = 0;
+    for(uint32_t ms = 0; ms < 60000UL; ms += 500) { if(g.tryCharge(m * 60000UL + ms, 8)) { ++slot; } }
+    hour += slot;
+    if((m >= 59) && (hour > maxHourFrames)) { maxHourFrames = hour; }
+    }
+  const uint32_t maxHour = maxHourFrames * 25600UL;
+  AssertIsTrue(maxHour <= 36000000UL);
+  AssertIsTrue(maxHour > 35000000UL);
+  // Out-of-range configuration is clamped.
+  A c(0, 0xffffffffUL);
+  AssertIsEqual(1800000UL, c.getBurstUs()); // Half the hourly budget at 0.1%.
+  AssertIsEqual(500UL, c.getRateUsPerS());
+  }
+
+// Do some basic testing of the adaptive poll interval.
+static void testPollInterval()
+  {
+  Serial.println("PollInterval");
+  typedef OTProtocolCC::CC1PollIntervalPolicy<4> P;
+  static P p;
+  p.clear();
+  // Unknown relays are polled often.
+  AssertIsEqual(P::min_interval_s, p.getIntervalS(10, 21));
+  AssertIsEqual(30000UL, p.getIntervalMs(10, 21));
+  // Quiet responses back off to the maximum and stay there.
+  const OTProtocolCC::CC1PollResponse q = OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 80, 50, false, false, false);
+  uint32_t t = 0xffff0000UL; // Clock about to wrap.
+  AssertIsEqual(P::min_interval_s, p.onResponse(q, t));
+  t += 30000UL;
+  AssertIsEqual(60, p.onResponse(q, t));
+  t += 60000UL;
+  AssertIsEqual(120, p.onResponse(q, t));
+  for(int i = 0; i < 8; ++i) { t += p.getIntervalMs(10, 21); p.onResponse(q, t); }
+  AssertIsEqual(P::max_interval_s, p.getIntervalS(10, 21));
+  // Small temperature drift is not activity.
+  t += p.getIntervalMs(10, 21);
+  AssertIsEqual(P::max_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 81, 50, false, false, false), t));
+  // Nor is a larger normal drift over a long interval...
+  t += p.getIntervalMs(10, 21);
+  AssertIsEqual(P::max_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 83, 50, false, false, false), t));
+  // ...though the same move within the minimum interval is.
+  t += 30000UL;
+  AssertIsEqual(P::min_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 81, 50, false, false, false), t));
+  t += 30000UL;
+  AssertIsEqual(60, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 81, 50, false, false, false), t));
+  // A move in proportion to the time since the last response counts: 4 in 60s.
+  t += 60000UL;
+  AssertIsEqual(P::min_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 85, 50, false, false, false), t));
+  // Switch toggle or window change is, whatever the interval.
+  t += 30000UL;
+  AssertIsEqual(60, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 85, 50, false, false, false), t));
+  t += 60000UL;
+  AssertIsEqual(P::min_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 85, 50, true, false, false), t));
+  t += 30000UL;
+  AssertIsEqual(60, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 85, 50, true, false, false), t));
+  t += 60000UL;
+  AssertIsEqual(P::min_interval_s, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 85, 50, true, true, false), t));
+  // Relays are independent.
+  AssertIsEqual(P::min_interval_s, p.getIntervalS(10, 22));
+  AssertIsEqual(1, p.size());
+  // Invalid responses are ignored.
+  OTProtocolCC::CC1PollResponse bad;
+  bad.forceInvalid();
+  AssertIsEqual(0, p.onResponse(bad, t));
+  // Plugs into the command differ as the keepalive.
+  static OTProtocolCC::CC1CommandDiffer<4> d;
+  d.clear();
+  const OTProtocolCC::CC1PollAndCommand c = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1);
+  AssertIsTrue(d.onSent(c, 0));
+  AssertIsTrue(d.onAcknowledged(10, 21, 1000));
+  AssertIsTrue(!d.needsTransmission(c, 1000 + p.getIntervalMs(10, 21) - 1, p.getIntervalMs(10, 21)));
+  AssertIsTrue(d.needsTransmission(c, 1000 + p.getIntervalMs(10, 21), p.getIntervalMs(10, 21)));
+  }
+
+// Do some basic testing of the decoded-frame cache.
+static void testDecodeCache()
+  {
+  Serial.println("DecodeCache");
+  static OTProtocolCC::CC1DecodeCache<OTProtocolCC::CC1PollResponse, 4> c;
+  c.clear();
+  uint8_t b1[8], b2[8];
+  const OTProtocolCC::CC1PollResponse r1 = OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 41, 50, true, false, true);
+  AssertIsEqual(8, r1.encodeSimple(b1, sizeof(b1), true));
+  // First sight is a miss, repeat is a hit with the same result.
+  OTProtocolCC::CC1PollResponse d;
+  AssertIsEqual(8, c.decode(d, b1, sizeof(b1)));
+  AssertIsTrue(d.isValid());
+  AssertIsEqual(0, c.getHits());
+  AssertIsEqual(1, c.getMisses());
+  d.forceInvalid();
+  AssertIsEqual(8, c.decode(d, b1, sizeof(b1)));
+  AssertIsTrue(d.isValid());
+  AssertIsEqual(41, d.getTR());
+  AssertIsEqual(50, d.getAL());
+  AssertIsTrue(d.getSY());
+  AssertIsEqual(1, c.getHits());
+  // A corrupted copy is fully checked and rejected, and does not evict the good entry.
+  memcpy(b2, b1, sizeof(b2));
+  b2[4] ^= 4;
+  AssertIsEqual(0, c.decode(d, b2, sizeof(b2)));
+  AssertIsTrue(!d.isValid());
+  AssertIsEqual(8, c.decode(d, b1, sizeof(b1)));
+  AssertIsEqual(2, c.getHits());
+  // Different valid frames decode correctly whether or not they collide.
+  for(int i = 0; i < 32; ++i)
+    {
+    const uint8_t tr = OTV0P2BASE::randRNG8() % 200;
+    AssertIsEqual(8, OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, tr, 50, true, false, true).encodeSimple(b2, sizeof(b2), true));
+    AssertIsEqual(8, c.decode(d, b2, sizeof(b2)));
+    AssertIsEqual(tr, d.getTR());
+    }
+  // Short buffers are rejected as by decodeSimple().
+  AssertIsEqual(0, c.decode(d, b1, 7));
+  AssertIsEqual(0, c.decode(d, NULL, 8));
+  // Works for other fixed-length types.
+  static OTProtocolCC::CC1DecodeCache<OTProtocolCC::CC1Alert, 2> ca;
+  OTProtocolCC::CC1Alert a;
+  AssertIsEqual(8, OTProtocolCC::CC1Alert::make(10, 21, 5).encodeSimple(b1, sizeof(b1), true));
+  AssertIsEqual(8, ca.decode(a, b1, sizeof(b1)));
+  AssertIsEqual(8, ca.decode(a, b1, sizeof(b1)));
+  AssertIsEqual(5, a.getSeq());
+  AssertIsEqual(1, ca.getHits());
+  }
+
+// Check the compile-time-selected CRC7 kernel is bit-exact against OTRadioLink.
+static void testCRC7Kernel()
+  {
+  Serial.println("CRC7Kernel");
+  uint8_t buf[7];
+  // The single-byte update, as used outside computeCRC7(), for every value including a zero CRC.
+  for(uint16_t c = 0; c < 0x100; ++c)
+    {
+    for(uint16_t d = 0; d < 0x100; ++d)
+      { AssertIsEqual(OTRadioLink::crc7_5B_update((uint8_t)c, (uint8_t)d), OTProtocolCC::CC1Base::crc7Update((uint8_t)c, (uint8_t)d)); }
+    }
+  // Every (non-zero) starting value and every data byte.
+  for(uint16_t c = 1; c < 0x100; ++c)
+    {
+    buf[0] = (uint8_t)c;
+    for(uint16_t d = 0; d < 0x100; ++d)
+      {
+      buf[1] = (uint8_t)d;
+      const uint8_t expected = OTRadioLink::crc7_5B_update((uint8_t)c, (uint8_t)d);
+      AssertIsEqual((0 == expected) ? OTRadioLink::crc7_5B_update_nz_ALT : expected, OTProtocolCC::CC1Base::computeCRC7(buf, 2, 2));
+      }
+    }
+  // Random frames of every length.
+  for(int i = 0; i < 256; ++i)
+    {
+    for(int j = 0; j < 7; ++j) { buf[j] = OTV0P2BASE::randRNG8(); }
+    buf[0] |= 1;
+    const uint8_t len = 1 + (i % 7);
+    uint8_t expected = buf[0];
+    for(uint8_t j = 1; j < len; ++j) { expected = OTRadioLink::crc7_5B_update(expected, buf[j]); }
+    if(0 == expected) { expected = OTRadioLink::crc7_5B_update_nz_ALT; }
+    AssertIsEqual(expected, OTProtocolCC::CC1Base::computeCRC7(buf, sizeof(buf), len));
+    }
+  }
+
+// Check batch CRC screening against the single-frame check.
+static void testVerifyCRCBatch()
+  {
+  Serial.println("VerifyCRCBatch");
+  const size_t n = 19; // Not a multiple of 8.
+  uint8_t frames[n][8];
+  uint8_t okMask[3];
+  for(int round = 0; round < 16; ++round)
+    {
+    for(size_t i = 0; i < n; ++i)
+      {
+      uint8_t *const f = frames[i];
+      OTProtocolCC::CC1PollResponse::make(OTV0P2BASE::randRNG8() % 100, OTV0P2BASE::randRNG8() % 100,
+          OTV0P2BASE::randRNG8() % 51, 40, 41, 1 + (OTV0P2BASE::randRNG8() % 62), false, false, false).encodeSimple(f, 8, true);
+      switch(OTV0P2BASE::randRNG8() & 3)
+        {
+        case 0: { f[OTV0P2BASE::randRNG8() & 7] ^= (uint8_t)(1 << (OTV0P2BASE::randRNG8() & 7)); break; } // Corrupt.
+        case 1: { for(int j = 0; j < 8; ++j) { f[j] = OTV0P2BASE::randRNG8(); } break; } // Junk, occasionally passing.
+        case 2: { f[0] = 0; f[7] = OTProtocolCC::CC1Base::computeCRC7(f, 8, 7); break; } // Zero type.
+        default: break; // Valid.
+        }
+      }
+    okMask[2] = 0xff;
+    size_t expected = 0;
+    const size_t passed = OTProtocolCC::CC1Base::verifyCRCBatch(frames, n, okMask);
+    for(size_t i = 0; i < n; ++i)
+      {
+      const bool ok = OTProtocolCC::CC1Base::checkFrameCRC(frames[i], 8, 7);
+      if(ok) { ++expected; }
+      AssertIsTrue(ok == (0 != (okMask[i >> 3] & (1 << (i & 7)))));
+      }
+    AssertIsEqual(expected, passed);
+    AssertIsEqual(0, okMask[2] & 0xf8); // Bits beyond n are cleared.
+    }
+  // A frame with a zero CRC remainder carries the non-zero alternative.
+  uint8_t z[1][8] = { { '*', 0, 0, 0, 0, 0, 0, 0 } };
+  bool found = false;
+  for(uint32_t v = 0; !found && (v < 0x10000UL); ++v)
+    {
+    z[0][5] = (uint8_t)v; z[0][6] = (uint8_t)(v >> 8);
+    found = (OTRadioLink::crc7_5B_update_nz_ALT == OTProtocolCC::CC1Base::computeCRC7(z[0], 8, 7));
+    }
+  AssertIsTrue(found);
+  z[0][7] = OTRadioLink::crc7_5B_update_nz_ALT;
+  AssertIsEqual(1, OTProtocolCC::CC1Base::verifyCRCBatch(z, 1, okMask));
+  AssertIsEqual(1, okMask[0]);
+  }
+
+// Check that layout-generated messages are equivalent on the wire to the message classes built on them.
+static void testMessageTemplate()
+  {
+  Serial.println("MessageTemplate");
+  typedef OTProtocolCC::CC1PollResponseLayout PRL;
+  typedef OTProtocolCC::CC1Message<PRL> PR;
+  typedef OTProtocolCC::CC1PollAndCommandLayout PACL;
+  typedef OTProtocolCC::CC1Message<PACL> PAC;
+  typedef OTProtocolCC::CC1Message<OTProtocolCC::CC1AlertLayout> A;
+  uint8_t b1[8], b2[8];
+  // Default instance is invalid and will not encode.
+  PR bad;
+  AssertIsTrue(!bad.isValid());
+  AssertIsEqual(0, bad.encodeSimple(b1, sizeof(b1), true));
+  AssertIsTrue(!bad.set<PRL::TR>(1));
+  // Out-of-range values are rejected, leaving the field untouched.
+  PR r = PR::make(10, 21);
+  AssertIsTrue(r.isValid());
+  AssertIsTrue(r.set<PRL::TR>(199));
+  AssertIsTrue(!r.set<PRL::TR>(200));
+  AssertIsEqual(199, r.get<PRL::TR>());
+  AssertIsTrue(!r.set<PRL::AL>(0));
+  AssertIsTrue(!r.set<PRL::AL>(63));
+  // Random valid values encode identically to the message classes and decode back.
+  for(int i = 0; i < 64; ++i)
+    {
+    const uint8_t hc1 = OTV0P2BASE::randRNG8() % 100;
+    const uint8_t hc2 = OTV0P2BASE::randRNG8() % 100;
+    const uint8_t rh = OTV0P2BASE::randRNG8() % 51;
+    const uint8_t tp = OTV0P2BASE::randRNG8() % 200;
+    const uint8_t tr = OTV0P2BASE::randRNG8() % 200;
+    const uint8_t al = 1 + (OTV0P2BASE::randRNG8() % 62);
+    const uint8_t bits = OTV0P2BASE::randRNG8();
+    PR g = PR::make(hc1, hc2);
+    AssertIsTrue(g.set<PRL::RH>(rh) && g.set<PRL::TP>(tp) && g.set<PRL::TR>(tr) && g.set<PRL::AL>(al));
+    AssertIsTrue(g.set<PRL::S>(bits & 1) && g.set<PRL::W>((bits >> 1) & 1) && g.set<PRL::SY>((bits >> 2) & 1));
+    const OTProtocolCC::CC1PollResponse h = OTProtocolCC::CC1PollResponse::make(hc1, hc2, rh, tp, tr, al, bits & 1, (bits >> 1) & 1, (bits >> 2) & 1);
+    AssertIsEqual(8, g.encodeSimple(b1, sizeof(b1), true));
+    AssertIsEqual(8, h.encodeSimple(b2, sizeof(b2), true));
+    for(int j = 0; j < 8; ++j) { AssertIsEqual(b2[j], b1[j]); }
+    PR d;
+    AssertIsEqual(8, d.decodeSimple(b1, sizeof(b1)));
+    AssertIsEqual(tr, d.get<PRL::TR>());
+    AssertIsEqual(al, d.get<PRL::AL>());
+    const OTProtocolCC::CC1MessageView<PRL> v(b1, sizeof(b1));
+    AssertIsTrue(v.isValid());
+    AssertIsEqual(rh, v.get<PRL::RH>());
+    AssertIsEqual(hc2, v.getHC2());
+
+    const uint8_t rp = OTV0P2BASE::randRNG8() % 101;
+    const uint8_t lc = bits & 3;
+    const uint8_t lt = 1 + ((bits >> 2) % 15);
+    const uint8_t lf = 1 + ((bits >> 6) % 3);
+    const uint8_t seq = (bits & 0x10) ? OTProtocolCC::CC1Base::no_seq : (tp & OTProtocolCC::CC1Base::seq_mask);
+    PAC p = PAC::make(hc1, hc2);
+    AssertIsTrue(p.set<PACL::RP>(rp) && p.set<PACL::LC>(lc) && p.set<PACL::LT>(lt) && p.set<PACL::LF>(lf) && p.set<PACL::Seq>(seq));
+    AssertIsEqual(8, p.encodeSimple(b1, sizeof(b1), true));
+    AssertIsEqual(8, OTProtocolCC::CC1PollAndCommand::make(hc1, hc2, rp, lc, lt, lf, seq).encodeSimple(b2, sizeof(b2), true));
+    for(int j = 0; j < 8; ++j) { AssertIsEqual(b2[j], b1[j]); }
+
+    A a = A::make(hc1, hc2);
+    AssertIsTrue(a.set<OTProtocolCC::CC1AlertLayout::Seq>(seq));
+    AssertIsEqual(8, a.encodeSimple(b1, sizeof(b1), true));
+    AssertIsEqual(8, OTProtocolCC::CC1Alert::make(hc1, hc2, seq).encodeSimple(b2, sizeof(b2), true));
+    for(int j = 0; j < 8; ++j) { AssertIsEqual(b2[j], b1[j]); }
+    }
+  // Random frames (valid or corrupted) are accepted or rejected exactly as by the message classes.
+  for(int i = 0; i < 256; ++i)
+    {
+    const OTProtocolCC::CC1PollAndCommand c = OTProtocolCC::CC1PollAndCommand::make(OTV0P2BASE::randRNG8() % 100, 5,
+        OTV0P2BASE::randRNG8() % 101, 1, 2, 3, OTV0P2BASE::randRNG8() & 0x7f);
+    AssertIsEqual(8, c.encodeSimple(b1, sizeof(b1), true));
+    if(i & 1) { b1[OTV0P2BASE::randRNG8() & 7] ^= (uint8_t)(1 << (OTV0P2BASE::randRNG8() & 7)); }
+    if(i & 2) { b1[3 + (OTV0P2BASE::randRNG8() & 3)] = OTV0P2BASE::randRNG8(); b1[7] = OTProtocolCC::CC1Base::computeSimpleCRC(b1, sizeof(b1)); }
+    OTProtocolCC::CC1PollAndCommand h;
+    PAC g;
+    const uint8_t hn = h.OTProtocolCC::CC1PollAndCommand::decodeSimple(b1, sizeof(b1));
+    AssertIsEqual(hn, g.decodeSimple(b1, sizeof(b1)));
+    AssertIsTrue(h.isValid() == g.isValid());
+    AssertIsTrue(h.isValid() == PAC::check(b1, sizeof(b1)));
+    if(h.isValid()) { AssertIsEqual(h.getRP(), g.get<PACL::RP>()); AssertIsEqual(h.getSeq(), g.get<PACL::Seq>()); }
+    }
+  }
+
+// Do some basic testing of hub command diffing.
+static void testCommandDiffer()
+  {
+  Serial.println("CommandDiffer");
+  typedef OTProtocolCC::CC1CommandDiffer<4> D;
+  static D d;
+  d.clear();
+  const OTProtocolCC::CC1PollAndCommand c1 = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1);
+  const OTProtocolCC::CC1PollAndCommand c2 = OTProtocolCC::CC1PollAndCommand::make(10, 21, 60, 2, 3, 1);
+  const uint32_t t0 = 0xffffff00UL; // Clock about to wrap.
+  // Unknown relay always needs sending.
+  AssertIsTrue(d.needsTransmission(c1, t0));
+  AssertIsTrue(d.onSent(c1, t0));
+  // Not resent while awaiting the response...
+  AssertIsTrue(!d.needsTransmission(c1, t0 + 5000));
+  // ...but a changed command goes at once...
+  AssertIsTrue(d.needsTransmission(c2, t0 + 5000));
+  // ...and an unacknowledged one is resent after the response window.
+  AssertIsTrue(d.needsTransmission(c1, t0 + D::response_window_ms));
+  AssertIsTrue(d.onAcknowledged(10, 21, t0 + 6000));
+  AssertIsTrue(!d.onAcknowledged(10, 21, t0 + 6000)); // Nothing outstanding.
+  // Same command is suppressed until the keepalive is due.
+  AssertIsTrue(!d.needsTransmission(c1, t0 + 20000));
+  AssertIsTrue(!d.needsTransmission(c1, t0 + 6000 + D::default_keepalive_ms - 1));
+  AssertIsTrue(d.needsTransmission(c1, t0 + 6000 + D::default_keepalive_ms));
+  // A shorter keepalive can be given per call.
+  AssertIsTrue(d.needsTransmission(c1, t0 + 6000 + 60000, 60000));
+  // Sequence numbers are not part of the command.
+  AssertIsTrue(!d.needsTransmission(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 9), t0 + 20000));
+  // Changed command needs sending.
+  AssertIsTrue(d.needsTransmission(c2, t0 + 20000));
+  // Invalid commands never do.
+  OTProtocolCC::CC1PollAndCommand bad;
+  bad.forceInvalid();
+  AssertIsTrue(!d.needsTransmission(bad, t0));
+  AssertIsTrue(!d.onSent(bad, t0));
+  AssertIsEqual(1, d.size());
+  // A relay that never answers is retried with backoff, up to the keepalive.
+  AssertIsEqual(D::response_window_ms, D::retryWaitMs(0));
+  AssertIsEqual(2 * D::response_window_ms, D::retryWaitMs(1));
+  AssertIsEqual(D::default_keepalive_ms, D::retryWaitMs(200));
+  AssertIsEqual(60000, D::retryWaitMs(200, 60000));
+  const OTProtocolCC::CC1PollAndCommand c3 = OTProtocolCC::CC1PollAndCommand::make(10, 22, 50, 2, 3, 1);
+  uint32_t t = t0;
+  AssertIsTrue(d.onSent(c3, t));
+  for(uint8_t i = 0; i < 10; ++i)
+    {
+    const uint32_t w = D::retryWaitMs(i);
+    AssertIsTrue(!d.needsTransmission(c3, t + w - 1));
+    AssertIsTrue(d.needsTransmission(c3, t + w));
+    t += w;
+    AssertIsTrue(d.onSent(c3, t));
+    }
+  AssertIsTrue(!d.needsTransmission(c3, t + D::default_keepalive_ms - 1));
+  AssertIsTrue(d.needsTransmission(c3, t + D::default_keepalive_ms));
+  // A changed command goes at once and restarts the backoff...
+  const OTProtocolCC::CC1PollAndCommand c4 = OTProtocolCC::CC1PollAndCommand::make(10, 22, 60, 2, 3, 1);
+  AssertIsTrue(d.needsTransmission(c4, t + 1));
+  AssertIsTrue(d.onSent(c4, t + 1));
+  AssertIsTrue(d.needsTransmission(c4, t + 1 + D::response_window_ms));
+  // ...as does an acknowledgement.
+  AssertIsTrue(d.onSent(c4, t + 1 + D::response_window_ms));
+  AssertIsTrue(!d.needsTransmission(c4, t + 1 + 2 * D::response_window_ms));
+  AssertIsTrue(d.onAcknowledged(10, 22, t + 1 + 2 * D::response_window_ms));
+  AssertIsTrue(d.onSent(c3, t + 1 + 3 * D::response_window_ms));
+  AssertIsTrue(d.needsTransmission(c3, t + 1 + 4 * D::response_window_ms));
+  }
+
+// Do some basic testing of the relay TX scheduler.
+static void testRelayTxScheduler()
+  {
+  Serial.println("RelayTxScheduler");
+  typedef OTProtocolCC::CC1RelayTxScheduler S;
+  S s;
+  s.setHouseCode(10, 21);
+  AssertIsTrue(s.getSlot() < S::slots);
+  AssertIsEqual(0, s.due(0));
+  AssertIsTrue(S::never == s.msUntilNext(0));
+  // Response always lands inside the window, short of the guard, whatever the slot and jitter.
+  const uint32_t t0 = 0xfffff000UL; // Clock about to wrap.
+  const uint8_t jitter = OTV0P2BASE::randRNG8();
+  s.onPoll(t0, jitter);
+  const uint32_t wait = s.msUntilNext(t0);
+  AssertIsTrue(wait <= S::window_ms - S::guard_ms);
+  AssertIsTrue(wait >= (uint32_t)s.getSlot() * S::slot_ms);
+  if(wait > 0) { AssertIsEqual(0, s.due(t0 + wait - 1)); }
+  AssertIsEqual(S::send_response, s.due(t0 + wait));
+  AssertIsEqual(0, s.due(t0 + wait));
+  // Different house codes are spread over several slots.
+  uint16_t seen = 0;
+  for(uint8_t hc2 = 0; hc2 < 32; ++hc2) { S s2; s2.setHouseCode(10, hc2); seen |= (1U << s2.getSlot()); }
+  uint8_t distinct = 0;
+  for(uint8_t i = 0; i < 16; ++i) { if(seen & (1U << i)) { ++distinct; } }
+  AssertIsTrue(distinct >= 8);
+  // Alert with no response pending goes at once.
+  s.onAlert(1000);
+  AssertIsEqual(0, s.msUntilNext(1000));
+  AssertIsEqual(S::send_alert, s.due(1000));
+  // Alert shortly before a due response is held to go with it.
+  S s3;
+  s3.setHouseCode(10, 21);
+  s3.onPoll(0, 0);
+  const uint32_t rd = s3.msUntilNext(0);
+  if(rd > 0)
+    {
+    s3.onAlert(rd - 1);
+    AssertIsEqual(1, s3.msUntilNext(rd - 1));
+    AssertIsEqual(0, s3.due(rd - 1));
+    }
+  AssertIsEqual(S::send_response | S::send_alert, s3.due(rd));
+  // Alert long before the response goes at once, taking the response early with it.
+  S s4;
+  s4.setHouseCode(99, 99);
+  s4.onPoll(0, 255);
+  if(s4.msUntilNext(0) > S::alert_max_delay_ms)
+    {
+    s4.onAlert(0);
+    AssertIsEqual(S::send_response | S::send_alert, s4.due(0));
+    }
+  }
+
+// RAM-backed snapshot store that can be made to fail after a number of writes, to simulate power loss.
+class TestSnapshotStore : public OTProtocolCC::CC1SnapshotStore
+  {
+  public:
+    uint8_t mem[80];
+    uint8_t writesLeft;
+    uint8_t reads;
+    TestSnapshotStore() : writesLeft(0xff), reads(0) { memset(mem, 0xff, sizeof(mem)); }
+    virtual bool read(uint16_t addr, uint8_t *buf, uint8_t len)
+      {
+      ++reads;
+      if(addr + len > sizeof(mem)) { return(false); }
+      memcpy(buf, mem + addr, len);
+      return(true);
+      }
+    virtual bool write(uint16_t addr, const uint8_t *buf, uint8_t len)
+      {
+      if((0 == writesLeft) || (addr + len > sizeof(mem))) { return(false); }
+      if(0xff != writesLeft) { --writesLeft; }
+      memcpy(mem + addr, buf, len);
+      return(true);
+      }
+  };
+
+// Do some basic testing of registry snapshots.
+static void testSnapshot()
+  {
+  Serial.println("Snapshot");
+  typedef OTProtocolCC::CC1RegistrySnapshot<4> Snap;
+  AssertIsTrue(Snap::total_bytes <= sizeof(TestSnapshotStore().mem) - 2);
+  static TestSnapshotStore store;
+  memset(store.mem, 0xff, sizeof(store.mem));
+  store.writesLeft = 0xff;
+  static OTProtocolCC::CC1PollResponseRegistry<4> reg;
+  reg.clear();
+  Snap snap(store, 2);
+  AssertIsTrue(!snap.load(reg)); // Erased store holds nothing.
+  uint8_t buf[8];
+  AssertIsEqual(8, OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, true, false).encodeSimple(buf, sizeof(buf), true));
+  OTProtocolCC::CC1PollResponse r;
+  AssertIsEqual(8, reg.decode(buf, sizeof(buf), r));
+  AssertIsTrue(snap.save(reg));
+  AssertIsEqual(1, snap.getGeneration());
+  // Second relay, saved to the other slot.
+  AssertIsEqual(8, OTProtocolCC::CC1PollResponse::make(11, 22, 5, 100, 90, 2, true, false, false).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(8, reg.decode(buf, sizeof(buf), r));
+  AssertIsTrue(snap.save(reg));
+  // A fresh instance (as after restart) loads the latest.
+  static OTProtocolCC::CC1PollResponseRegistry<4> reg2;
+  Snap snap2(store, 2);
+  AssertIsTrue(snap2.load(reg2));
+  AssertIsEqual(2, snap2.getGeneration());
+  AssertIsEqual(2, reg2.size());
+  OTProtocolCC::CC1PollResponse r2;
+  AssertIsTrue(reg2.get(10, 21, r2));
+  AssertIsEqual(80, r2.getTR());
+  AssertIsTrue(r2.getW());
+  AssertIsTrue(reg2.get(11, 22, r2));
+  AssertIsEqual(90, r2.getTR());
+  // Power lost part way through the next save: the previous snapshot survives.
+  AssertIsEqual(8, OTProtocolCC::CC1PollResponse::make(12, 23, 5, 100, 90, 2, true, false, false).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(8, reg.decode(buf, sizeof(buf), r));
+  store.writesLeft = 1 + (OTV0P2BASE::randRNG8() % 4); // Header and up to 3 records, but no CRC.
+  AssertIsTrue(!snap.save(reg));
+  store.writesLeft = 0xff;
+  Snap snap3(store, 2);
+  AssertIsTrue(snap3.load(reg2));
+  AssertIsEqual(2, snap3.getGeneration());
+  AssertIsEqual(2, reg2.size());
+  AssertIsTrue(!reg2.get(12, 23, r2));
+  // After restart, saving continues from the latest generation without overwriting it.
+  AssertIsTrue(snap3.save(reg));
+  AssertIsEqual(3, snap3.getGeneration());
+  AssertIsTrue(Snap(store, 2).load(reg2));
+  AssertIsEqual(3, reg2.size());
+  // Corruption of the latest falls back to the other slot.
+  store.mem[2 + Snap::header_bytes] ^= 1; // First record of slot A, which holds generation 3.
+  AssertIsTrue(Snap(store, 2).load(reg2));
+  AssertIsEqual(2, reg2.size());
+  // A valid latest snapshot is loaded reading each record once:
+  // both headers, then the latest slot's header, 3 records and CRC.
+  Snap snap4(store, 2);
+  AssertIsTrue(snap4.load(reg2));
+  AssertIsTrue(snap4.save(reg));
+  AssertIsEqual(3, snap4.getGeneration());
+  store.reads = 0;
+  AssertIsTrue(Snap(store, 2).load(reg2));
+  AssertIsEqual(3, reg2.size());
+  AssertIsEqual(2 + 1 + 3 + 1, store.reads);
+  // A record the registry will not restore, even with a good CRC, falls back to the other slot.
+  store.mem[2 + Snap::header_bytes] = 0xff; // Invalid house code.
+  uint16_t crc = 0xffff;
+  for(uint8_t i = 0; i < Snap::header_bytes + 3 * Snap::record_bytes; ++i)
+    { crc = OTProtocolCC::CC1Base::crc16CCITTUpdate(crc, store.mem[2 + i]); }
+  store.mem[2 + Snap::header_bytes + 3 * Snap::record_bytes] = (uint8_t)(crc >> 8);
+  store.mem[2 + Snap::header_bytes + 3 * Snap::record_bytes + 1] = (uint8_t)crc;
+  Snap snap5(store, 2);
+  AssertIsTrue(snap5.load(reg2));
+  AssertIsEqual(2, snap5.getGeneration());
+  AssertIsEqual(2, reg2.size());
+
+  // Command differ, with times saved as ages and restored against a clock restarted from 0.
+  typedef OTProtocolCC::CC1CommandDiffer<2> D;
+  typedef OTProtocolCC::CC1CommandDifferSnapshot<2> DSnap;
+  AssertIsTrue(DSnap::total_bytes <= sizeof(store.mem));
+  memset(store.mem, 0xff, sizeof(store.mem));
+  static D d;
+  d.clear();
+  const OTProtocolCC::CC1PollAndCommand c1 = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1);
+  const OTProtocolCC::CC1PollAndCommand c2 = OTProtocolCC::CC1PollAndCommand::make(10, 21, 60, 2, 3, 1);
+  AssertIsTrue(d.onSent(c1, 1000));
+  AssertIsTrue(d.onAcknowledged(10, 21, 2000));
+  AssertIsTrue(d.onSent(c2, 5000));
+  AssertIsTrue(DSnap(store, 0).save(d, 6000));
+  static D d2;
+  AssertIsTrue(DSnap(store, 0).load(d2, 100));
+  AssertIsEqual(1, d2.size());
+  // c2 was sent 1000ms before the save, so is awaiting its response until 9100.
+  AssertIsTrue(!d2.needsTransmission(c2, 9099));
+  AssertIsTrue(d2.needsTransmission(c2, 9100));
+  // c1 was acknowledged 4000ms before the save, so its keepalive is due at 100 - 4000 + keepalive.
+  AssertIsTrue(!d2.needsTransmission(c1, 100 - 4000 + D::default_keepalive_ms - 1));
+  AssertIsTrue(d2.needsTransmission(c1, 100 - 4000 + D::default_keepalive_ms));
+  // A differ snapshot is not loaded as another table's.
+  static OTProtocolCC::CC1PollIntervalPolicy<2> p;
+  AssertIsTrue(!OTProtocolCC::CC1PollIntervalSnapshot<2>(store, 0).load(p, 100));
+
+  // Poll interval policy, likewise.
+  typedef OTProtocolCC::CC1PollIntervalSnapshot<2> PSnap;
+  AssertIsTrue(PSnap::total_bytes <= sizeof(store.mem));
+  memset(store.mem, 0xff, sizeof(store.mem));
+  p.clear();
+  AssertIsEqual(30, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false), 0));
+  AssertIsEqual(60, p.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 80, 30, false, false, false), 60000));
+  AssertIsTrue(PSnap(store, 0).save(p, 70000));
+  static OTProtocolCC::CC1PollIntervalPolicy<2> p2;
+  AssertIsTrue(PSnap(store, 0).load(p2, 5));
+  AssertIsEqual(60, p2.getIntervalS(10, 21));
+  // Last response was 10000ms before the save, so tr moving by 2 over the next 20000ms is activity.
+  AssertIsEqual(30, p2.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 25, 120, 82, 30, false, false, false), 20005));
+  }
+
+// Do some basic testing of the relay early acceptance filter.
+static void testRelayAcceptance()
+  {
+  Serial.println("RelayAcceptance");
+  OTProtocolCC::CC1RelayAcceptanceFilter f;
+  uint8_t buf[13];
+  AssertIsEqual(8, OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 8)); // Not configured.
+  f.setHouseCode(10, 0xff);
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 8)); // Invalid house code.
+  f.setHouseCode(10, 21);
+  // Decided incrementally as bytes arrive.
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::need_more, f.check(buf, 0));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::need_more, f.check(buf, 1));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::need_more, f.check(buf, 2));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::accept, f.check(buf, 3));
+  // Other relays are rejected as soon as a house code byte differs.
+  buf[1] = 11;
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 2));
+  buf[1] = 10;
+  buf[2] = 22;
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 3));
+  // Responses and alerts are never for a relay.
+  AssertIsEqual(8, OTProtocolCC::CC1Alert::make(10, 21).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 1));
+  // Multi-poll frames must be examined in full.
+  buf[0] = OTProtocolCC::CC1MultiPollAndCommand::frame_type;
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::accept, f.check(buf, 1));
+  // Group commands only for this relay's group and with a long enough bitmap.
+  OTProtocolCC::CC1GroupCommand g = OTProtocolCC::CC1GroupCommand::make(5, 50, 2, 3, 1);
+  AssertIsTrue(g.addMember(3));
+  AssertIsTrue(0 != g.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 3)); // No group set.
+  AssertIsTrue(f.setGroup(5, 3));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::need_more, f.check(buf, 2));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::need_more, f.check(buf, 5)); // Member bit not yet seen.
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::accept, f.check(buf, 6));
+  AssertIsTrue(f.setGroup(5, 4)); // In the bitmap but not addressed.
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 6));
+  AssertIsTrue(f.setGroup(5, 9)); // Bitmap is only one byte long.
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 3));
+  AssertIsTrue(f.setGroup(6, 3));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 2));
+  // An out-of-range member index is refused rather than silently rejecting everything.
+  AssertIsTrue(!f.setGroup(5, OTProtocolCC::CC1GroupCommand::max_members));
+  AssertIsEqual(OTProtocolCC::CC1RelayAcceptanceFilter::reject, f.check(buf, 6));
+  AssertIsTrue(f.setGroup(OTProtocolCC::CC1GroupCommand::invalid_gid, 0));
+  }
+
+// Print that captures output into a fixed buffer, for checking dumps.
+class CapturePrint : public Print
+  {
+  public:
+    uint8_t buf[256];
+    uint16_t len;
+    CapturePrint() : len(0) { }
+    virtual size_t write(uint8_t c) { if(len >= sizeof(buf)) { return(0); } buf[len++] = c; return(1); }
+  };
+
+// Print that counts output lines, and those exactly matching a target line.
+class LineMatchPrint : public Print
+  {
+  private:
+    const char *const target;
+    char line[64];
+    uint8_t len;
+  public:
+    uint16_t lines;
+    uint16_t matches;
+    explicit LineMatchPrint(const char *t) : target(t), len(0), lines(0), matches(0) { }
+    virtual size_t write(uint8_t c)
+      {
+      if('\r' == c) { return(1); }
+      if('\n' == c) { line[len] = '\0'; ++lines; if(0 == strcmp(line, target)) { ++matches; } len = 0; return(1); }
+      if(len < sizeof(line) - 1) { line[len++] = c; }
+      return(1);
+      }
+  };
+
+// Do some basic testing of the metrics counters and exposition.
+static void testMetrics()
+  {
+  Serial.println("Metrics");
+  static OTProtocolCC::CC1Metrics m;
+  m.clear();
+  uint8_t buf[8];
+  AssertIsEqual(8, OTProtocolCC::CC1Alert::make(10, 21).encodeSimple(buf, sizeof(buf), true));
+  OTProtocolCC::CC1Alert a;
+  AssertIsEqual(8, m.decode(a, buf, sizeof(buf)));
+  AssertIsEqual(1, m.getDecoded(OTProtocolCC::CC1Metrics::type_alert));
+  // Failures are classified.
+  buf[7] ^= 1;
+  AssertIsEqual(0, m.decode(a, buf, sizeof(buf)));
+  AssertIsEqual(1, m.getFailures(OTProtocolCC::CC1Metrics::fail_crc));
+  AssertIsEqual(0, m.decode(a, buf, 5));
+  AssertIsEqual(1, m.getFailures(OTProtocolCC::CC1Metrics::fail_short));
+  buf[7] ^= 1;
+  buf[3] = 2; // Bad extension byte.
+  buf[7] = OTProtocolCC::CC1Base::computeSimpleCRC(buf, sizeof(buf));
+  AssertIsEqual(0, m.decode(a, buf, sizeof(buf)));
+  AssertIsEqual(1, m.getFailures(OTProtocolCC::CC1Metrics::fail_field));
+  buf[0] = 'Z';
+  AssertIsEqual(OTProtocolCC::CC1Metrics::fail_type, OTProtocolCC::CC1Metrics::classifyFailure(buf, sizeof(buf)));
+  m.countDedupHit();
+  m.setRxQueue(1, 2);
+  m.recordPollRtt(120);
+  m.recordPollRtt(9000);
+  AssertIsEqual(2, m.getPollRtt().getCount());
+  // Exposition has the expected lines.
+  LineMatchPrint p1("otcc_frames_decoded_total{type=\"alert\"} 1");
+  m.printPrometheus(p1);
+  AssertIsEqual(1, p1.matches);
+  LineMatchPrint p2("otcc_poll_rtt_seconds_bucket{le=\"+Inf\"} 2");
+  m.printPrometheus(p2);
+  AssertIsEqual(1, p2.matches);
+  LineMatchPrint p3("otcc_poll_rtt_seconds_bucket{le=\"0.25\"} 1");
+  m.printPrometheus(p3);
+  AssertIsEqual(1, p3.matches);
+  // RTT buckets span the whole 10s response window.
+  LineMatchPrint p5("otcc_poll_rtt_seconds_bucket{le=\"10\"} 2");
+  m.printPrometheus(p5);
+  AssertIsEqual(1, p5.matches);
+  LineMatchPrint p8("otcc_poll_rtt_seconds_bucket{le=\"0.05\"} 0");
+  m.printPrometheus(p8);
+  AssertIsEqual(1, p8.matches);
+  AssertIsEqual(0, OTProtocolCC::CC1RttHistogram::bucketFor(50));
+  AssertIsEqual(1, OTProtocolCC::CC1RttHistogram::bucketFor(51));
+  AssertIsEqual(9, OTProtocolCC::CC1RttHistogram::bucketFor(10000));
+  AssertIsEqual(10, OTProtocolCC::CC1RttHistogram::bucketFor(10001));
+  // Saturating drop count is a gauge.
+  LineMatchPrint p6("otcc_rx_queue_dropped 2");
+  m.printPrometheus(p6);
+  AssertIsEqual(1, p6.matches);
+  LineMatchPrint p7("# TYPE otcc_rx_queue_dropped gauge");
+  m.printPrometheus(p7);
+  AssertIsEqual(1, p7.matches);
+  LineMatchPrint p4("otcc_poll_rtt_seconds_sum 9.12");
+  m.printPrometheus(p4);
+  AssertIsEqual(1, p4.matches);
+  AssertIsEqual(p1.lines, p4.lines);
+  }
+
+// Do some basic testing of latency histograms.
+static void testLatency()
+  {
+  Serial.println("Latency");
+  AssertIsEqual(0, OTProtocolCC::CC1LatencyHistogram::bucketFor(0));
+  AssertIsEqual(0, OTProtocolCC::CC1LatencyHistogram::bucketFor(1));
+  AssertIsEqual(1, OTProtocolCC::CC1LatencyHistogram::bucketFor(2));
+  AssertIsEqual(2, OTProtocolCC::CC1LatencyHistogram::bucketFor(7));
+  AssertIsEqual(10, OTProtocolCC::CC1LatencyHistogram::bucketFor(2047));
+  AssertIsEqual(11, OTProtocolCC::CC1LatencyHistogram::bucketFor(2048));
+  AssertIsEqual(11, OTProtocolCC::CC1LatencyHistogram::bucketFor(32767));
+  AssertIsEqual(12, OTProtocolCC::CC1LatencyHistogram::bucketFor(100000));
+  AssertIsEqual(13, OTProtocolCC::CC1LatencyHistogram::bucketFor(3000000UL));
+  // A stall near the 10s poll response window is told apart from a few ms outlier.
+  AssertIsEqual(14, OTProtocolCC::CC1LatencyHistogram::bucketFor(10000000UL));
+  AssertIsEqual(14, OTProtocolCC::CC1LatencyHistogram::bucketFor(0xffffffffUL));
+  AssertIsEqual(7, OTProtocolCC::CC1LatencyHistogram::bucketUpperBound(2));
+  AssertIsEqual(2047, OTProtocolCC::CC1LatencyHistogram::bucketUpperBound(10));
+  AssertIsEqual(32767, OTProtocolCC::CC1LatencyHistogram::bucketUpperBound(11));
+  AssertIsEqual(8388607UL, OTProtocolCC::CC1LatencyHistogram::bucketUpperBound(13));
+  for(uint8_t i = 1; i < OTProtocolCC::CC1LatencyHistogram::buckets; ++i)
+    {
+    AssertIsEqual(i, OTProtocolCC::CC1LatencyHistogram::bucketFor(OTProtocolCC::CC1LatencyHistogram::bucketUpperBound(i - 1) + 1));
+    }
+  OTProtocolCC::CC1LatencyHistogram h;
+  AssertIsEqual(0, h.getPercentileUpperBound(500));
+  for(uint8_t i = 0; i < 98; ++i) { h.record(5); }
+  h.record(300);
+  h.record(5000);
+  AssertIsEqual(100, h.getCount());
+  AssertIsEqual(7, h.getPercentileUpperBound(500));
+  AssertIsEqual(7, h.getPercentileUpperBound(980));
+  AssertIsEqual(511, h.getPercentileUpperBound(990));
+  AssertIsEqual(5000, h.getPercentileUpperBound(1000)); // Capped by the max seen.
+  // Merge adds counts and keeps the larger max.
+  OTProtocolCC::CC1LatencyHistogram h2;
+  h2.record(70000);
+  h.merge(h2);
+  AssertIsEqual(101, h.getCount());
+  AssertIsEqual(70000UL, h.maxUs);
+  h2.record(10000000UL);
+  AssertIsEqual(10000000UL, h2.getPercentileUpperBound(1000));
+  AssertIsEqual(OTProtocolCC::CC1DecodeLatency::type_poll_response, OTProtocolCC::CC1DecodeLatency::typeIndex('*'));
+  AssertIsEqual(OTProtocolCC::CC1DecodeLatency::type_other, OTProtocolCC::CC1DecodeLatency::typeIndex('&'));
+#ifdef OTPROTOCOLCC_ENABLE_LATENCY
+  OTProtocolCC::CC1DecodeLatency::clear();
+  uint8_t buf[8];
+  AssertIsEqual(8, OTProtocolCC::CC1Alert::make(10, 21).encodeSimple(buf, sizeof(buf), true));
+  OTProtocolCC::CC1Alert a;
+  AssertIsEqual(8, a.decodeSimple(buf, sizeof(buf)));
+  buf[7] ^= 1;
+  AssertIsEqual(0, a.decodeSimple(buf, sizeof(buf)));
+  OTProtocolCC::CC1LatencyHistogram s;
+  OTProtocolCC::CC1DecodeLatency::snapshot(OTProtocolCC::CC1DecodeLatency::type_alert, OTProtocolCC::CC1DecodeLatency::stage_validate, s);
+  AssertIsEqual(2, s.getCount());
+  OTProtocolCC::CC1DecodeLatency::snapshot(OTProtocolCC::CC1DecodeLatency::type_alert, OTProtocolCC::CC1DecodeLatency::stage_crc, s);
+  AssertIsEqual(1, s.getCount()); // Failed CRC stage is not recorded.
+  OTProtocolCC::CC1DecodeLatency::snapshot(OTProtocolCC::CC1DecodeLatency::type_poll_response, OTProtocolCC::CC1DecodeLatency::stage_crc, s);
+  AssertIsEqual(0, s.getCount());
+  // Dispatch is timed by the caller.
+  OTProtocolCC::CC1LatencyStopwatch sw(OTProtocolCC::CC1DecodeLatency::type_alert);
+  sw.lap(OTProtocolCC::CC1DecodeLatency::stage_dispatch);
+  OTProtocolCC::CC1DecodeLatency::snapshot(OTProtocolCC::CC1DecodeLatency::type_alert, OTProtocolCC::CC1DecodeLatency::stage_dispatch, s);
+  AssertIsEqual(1, s.getCount());
+  OTProtocolCC::CC1DecodeLatency::clear();
+#endif
+  }
+
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+// Print that makes a traced call for every byte written, as an ISR might during a dump.
+class ReentrantTracePrint : public Print
+  {
+  public:
+    virtual size_t write(uint8_t)
+      {
+      uint8_t b[8];
+      OTProtocolCC::CC1Alert::make(1, 2).encodeSimple(b, sizeof(b), true);
+      return(1);
+      }
+  };
+#endif
+
+// Do some basic testing of the trace ring buffer and its dump formats.
+static void testTrace()
+  {
+  Serial.println("Trace");
+  // Converter rejects bad input and handles an empty dump with tracing on or off.
+  static const uint8_t empty[] = { 'C', 'C', '1', 'T', 1, 0 };
+  static const uint8_t bad[] = { 'C', 'C', '1', 'X', 1, 0 };
+  CapturePrint cp;
+  AssertIsEqual(0, OTProtocolCC::CC1Trace::convertBinary(empty, sizeof(empty), cp));
+  AssertIsEqual(-1, OTProtocolCC::CC1Trace::convertBinary(bad, sizeof(bad), cp));
+  AssertIsEqual(-1, OTProtocolCC::CC1Trace::convertBinary(empty, 4, cp));
+#ifdef OTPROTOCOLCC_ENABLE_TRACE
+  OTProtocolCC::CC1Trace::clear();
+  AssertIsEqual(0, OTProtocolCC::CC1Trace::size());
+  uint8_t buf[8];
+  const OTProtocolCC::CC1Alert a = OTProtocolCC::CC1Alert::make(10, 21);
+  AssertIsEqual(8, a.encodeSimple(buf, sizeof(buf), true));
+  OTProtocolCC::CC1Alert a2;
+  AssertIsEqual(8, a2.decodeSimple(buf, sizeof(buf)));
+  buf[7] ^= 1;
+  AssertIsEqual(0, a2.decodeSimple(buf, sizeof(buf)));
+  // Each encode and decode also records the CRC computed within it, which completes first.
+  AssertIsEqual(6, OTProtocolCC::CC1Trace::size());
+  OTProtocolCC::CC1TraceEvent e;
+  AssertIsTrue(OTProtocolCC::CC1Trace::get(0, e));
+  AssertIsEqual(OTProtocolCC::CC1Trace::ev_crc, e.event);
+  AssertIsEqual('!', e.type);
+  AssertIsTrue(OTProtocolCC::CC1Trace::get(1, e));
+  AssertIsEqual(OTProtocolCC::CC1Trace::ev_encode, e.event);
+  AssertIsEqual('!', e.type);
+  AssertIsEqual(21, e.hc2);
+  AssertIsEqual(8, e.result);
+  AssertIsTrue(OTProtocolCC::CC1Trace::get(4, e));
+  AssertIsEqual(OTProtocolCC::CC1Trace::ev_crc, e.event);
+  AssertIsTrue(0 != e.result);
+  AssertIsTrue(OTProtocolCC::CC1Trace::get(5, e));
+  AssertIsEqual(OTProtocolCC::CC1Trace::ev_decode, e.event);
+  AssertIsEqual(0, e.result); // Failed.
+  AssertIsTrue(!OTProtocolCC::CC1Trace::get(6, e));
+  // Binary dump converts to the same text as the direct text dump.
+  CapturePrint bin;
+  OTProtocolCC::CC1Trace::dumpBinary(bin);
+  AssertIsEqual(6 + 6*11, bin.len);
+  CapturePrint t1, t2;
+  OTProtocolCC::CC1Trace::dumpText(t1);
+  AssertIsEqual(6, OTProtocolCC::CC1Trace::convertBinary(bin.buf, bin.len, t2));
+  AssertIsEqual(t1.len, t2.len);
+  AssertIsEqual(0, memcmp(t1.buf, t2.buf, t1.len));
+  // Calls traced during a dump (as from an ISR) are dropped rather than disturbing it.
+  ReentrantTracePrint rp;
+  OTProtocolCC::CC1Trace::dumpBinary(rp);
+  AssertIsEqual(6, OTProtocolCC::CC1Trace::size());
+  a.encodeSimple(buf, sizeof(buf), true);
+  AssertIsEqual(8, OTProtocolCC::CC1Trace::size()); // Recording resumes after the dump.
+  // Ring keeps only the most recent events.
+  for(uint8_t i = 0; i < OTPROTOCOLCC_TRACE_EVENTS + 2; ++i) { a.encodeSimple(buf, sizeof(buf), true); }
+  AssertIsEqual(OTPROTOCOLCC_TRACE_EVENTS, OTProtocolCC::CC1Trace::size());
+  OTProtocolCC::CC1Trace::clear();
+#endif
+  }
+
+// Do some basic testing of the unit conversions.
+static void testUnits()
+  {
+  Serial.println("Units");
+  // Scalar fixed point, both ways, including rounding and clamping.
+  AssertIsEqual(9950, OTProtocolCC::CC1Units::tpToCentiC(199));
+  AssertIsEqual(2025, OTProtocolCC::CC1Units::trToCentiC(81));
+  AssertIsEqual(1000, OTProtocolCC::CC1Units::rhToPermille(50));
+  AssertIsEqual(81, OTProtocolCC::CC1Units::centiCToTR(2020));
+  AssertIsEqual(80, OTProtocolCC::CC1Units::centiCToTR(2012));
+  AssertIsEqual(199, OTProtocolCC::CC1Units::centiCToTP(60000));
+  AssertIsEqual(50, OTProtocolCC::CC1Units::permilleToRH(1001));
+  AssertIsEqual(23, OTProtocolCC::CC1Units::permilleToRH(455));
+  // Every field value round-trips.
+  const uint8_t v = OTV0P2BASE::randRNG8() % 200;
+  AssertIsEqual(v, OTProtocolCC::CC1Units::centiCToTP(OTProtocolCC::CC1Units::tpToCentiC(v)));
+  AssertIsEqual(v, OTProtocolCC::CC1Units::centiCToTR(OTProtocolCC::CC1Units::trToCentiC(v)));
+  AssertIsEqual(v / 4, OTProtocolCC::CC1Units::permilleToRH(OTProtocolCC::CC1Units::rhToPermille(v / 4)));
+  AssertIsEqual(v, OTProtocolCC::CC1Units::cToTR(OTProtocolCC::CC1Units::trToC(v)));
+  // Float.
+  AssertIsTrue(20.25f == OTProtocolCC::CC1Units::trToC(81));
+  AssertIsEqual(41, OTProtocolCC::CC1Units::cToTP(20.4f));
+  AssertIsEqual(0, OTProtocolCC::CC1Units::cToTP(-5.0f));
+  AssertIsEqual(50, OTProtocolCC::CC1Units::percentToRH(101.0f));
+  // Batch matches scalar.
+  const uint8_t in[4] = { 0, 1, v, 199 };
+  uint16_t cC[4];
+  uint8_t back[4];
+  float c[4];
+  OTProtocolCC::CC1Units::trToCentiC(in, cC, 4);
+  OTProtocolCC::CC1Units::centiCToTR(cC, back, 4);
+  OTProtocolCC::CC1Units::tpToC(in, c, 4);
+  for(uint8_t i = 0; i < 4; ++i)
+    {
+    AssertIsEqual(OTProtocolCC::CC1Units::trToCentiC(in[i]), cC[i]);
+    AssertIsEqual(in[i], back[i]);
+    AssertIsTrue(OTProtocolCC::CC1Units::tpToC(in[i]) == c[i]);
+    }
+  }
+
+// Do some basic testing of pre-encoded frames with in-place patching.
+static void testEncodedFrame()
+  {
+  Serial.println("EncodedFrame");
+  uint8_t buf[8];
+  OTProtocolCC::CC1EncodedFrame f;
+  AssertIsTrue(!f.isValid());
+  AssertIsEqual(0, f.getLength());
+  AssertIsTrue(!f.setTR(1)); // Nothing to patch.
+  // Patched response must always match a fresh full encoding of the same values.
+  const uint8_t rh = OTV0P2BASE::randRNG8() % 51;
+  const uint8_t tp = OTV0P2BASE::randRNG8() % 200;
+  const uint8_t tr = OTV0P2BASE::randRNG8() % 200;
+  const uint8_t al = 1 + (OTV0P2BASE::randRNG8() % 62);
+  const bool w = (0 != (OTV0P2BASE::randRNG8() & 1));
+  const bool sy = (0 != (OTV0P2BASE::randRNG8() & 1));
+  AssertIsTrue(f.set(OTProtocolCC::CC1PollResponse::make(10, 21, 0, 0, 0, 1, false, false, false)));
+  AssertIsEqual(8, f.getLength());
+  AssertIsTrue(f.setRH(rh));
+  AssertIsTrue(f.setTP(tp));
+  AssertIsTrue(f.setTR(tr));
+  AssertIsTrue(f.setAL(al));
+  AssertIsTrue(f.setW(w));
+  AssertIsTrue(f.setS(true));
+  AssertIsTrue(f.setSY(sy));
+  AssertIsEqual(8, OTProtocolCC::CC1PollResponse::make(10, 21, rh, tp, tr, al, true, w, sy).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(0, memcmp(buf, f.getBytes(), sizeof(buf)));
+  OTProtocolCC::CC1PollResponse r;
+  AssertIsEqual(8, r.decodeSimple(f.getBytes(), f.getLength()));
+  AssertIsEqual(tr, r.getTR());
+  // Out-of-range values and fields of other frame types are rejected without change.
+  AssertIsTrue(!f.setTR(200));
+  AssertIsTrue(!f.setAL(0));
+  AssertIsTrue(!f.setRP(1));
+  AssertIsTrue(!f.setSeq(1));
+  AssertIsEqual(0, memcmp(buf, f.getBytes(), sizeof(buf)));
+  // Poll/command.
+  AssertIsTrue(f.set(OTProtocolCC::CC1PollAndCommand::make(10, 21, 0, 2, 3, 1)));
+  AssertIsTrue(f.setRP(100));
+  AssertIsTrue(f.setSeq(7));
+  AssertIsTrue(!f.setTR(1));
+  AssertIsEqual(8, OTProtocolCC::CC1PollAndCommand::make(10, 21, 100, 2, 3, 1, 7).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(0, memcmp(buf, f.getBytes(), sizeof(buf)));
+  // Alert.
+  AssertIsTrue(f.set(OTProtocolCC::CC1Alert::make(10, 21, 3)));
+  AssertIsTrue(f.setSeq(OTProtocolCC::CC1Base::no_seq));
+  AssertIsEqual(55, f.getBytes()[7]);
+  // Invalid messages are not accepted.
+  OTProtocolCC::CC1Alert a;
+  a.forceInvalid();
+  AssertIsTrue(!f.set(a));
+  AssertIsTrue(!f.isValid());
+  }
+
+// Do some basic testing of the static message pools.
+static void testMessagePool()
+  {
+  Serial.println("MessagePool");
+  static OTProtocolCC::CC1MessageArena<1, 2, 1> arena;
+  arena.clear();
+  OTProtocolCC::CC1PollAndCommand *const p1 = arena.polls.acquire();
+  OTProtocolCC::CC1PollAndCommand *const p2 = arena.polls.acquire();
+  AssertIsTrue(NULL != p1);
+  AssertIsTrue(NULL != p2);
+  AssertIsTrue(p1 != p2);
+  AssertIsTrue(!p1->isValid()); // Acquired instances start invalid.
+  AssertIsTrue(NULL == arena.polls.acquire()); // Exhausted.
+  AssertIsEqual(2, arena.polls.getInUse());
+  AssertIsEqual(1, arena.polls.getFailures());
+  // Instances are usable as normal.
+  uint8_t buf[8];
+  AssertIsEqual(8, OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1).encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(8, p1->decodeSimple(buf, sizeof(buf)));
+  AssertIsTrue(p1->isValid());
+  // Release, including rejection of a double release.
+  AssertIsTrue(arena.polls.release(p1));
+  AssertIsTrue(!arena.polls.release(p1));
+  AssertIsEqual(2, arena.polls.getFailures());
+  OTProtocolCC::CC1PollAndCommand *const p3 = arena.polls.acquire();
+  AssertIsTrue(p1 == p3); // Most recently released is reused.
+  AssertIsTrue(!p3->isValid()); // Old content is not visible.
+  AssertIsTrue(arena.polls.release(p2));
+  AssertIsTrue(arena.polls.release(p3));
+  AssertIsEqual(0, arena.polls.getInUse());
+  AssertIsEqual(2, arena.polls.getHighWater());
+  // Foreign pointers are rejected.
+  OTProtocolCC::CC1PollAndCommand local;
+  AssertIsTrue(!arena.polls.release(&local));
+  // Other pools are independent.
+  OTProtocolCC::CC1Alert *const a = arena.alerts.acquire();
+  AssertIsTrue(NULL != a);
+  AssertIsTrue(NULL == arena.alerts.acquire());
+  AssertIsTrue(arena.alerts.release(a));
+  AssertIsEqual(1, arena.responses.capacity);
+  }
+
+// Do some basic testing of the ISR-safe relay receive filter and queue.
+static void testRelayRx()
+  {
+  Serial.println("RelayRx");
+  uint8_t buf[8];
+  const OTProtocolCC::CC1PollAndCommand p = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 5);
+  AssertIsEqual(8, p.encodeSimple(buf, sizeof(buf), true));
+  // Filter accepts exactly what the full decoder does.
+  AssertIsTrue(OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(buf, sizeof(buf), 10, 21));
+  AssertIsTrue(!OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(buf, sizeof(buf), 10, 22));
+  AssertIsTrue(!OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(buf, 7, 10, 21));
+  AssertIsTrue(!OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(NULL, 8, 10, 21));
+  // A 0xff house code byte never matches, since it would not decode to a valid instance.
+  uint8_t bad[8];
+  memcpy(bad, buf, sizeof(bad));
+  bad[2] = 0xff;
+  bad[7] = OTProtocolCC::CC1Base::computeSimpleCRC(bad, sizeof(bad));
+  AssertIsTrue(!OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(bad, sizeof(bad), 10, 0xff));
+  static OTProtocolCC::CC1RelayRxQueue<2> q;
+  q.setHouseCode(10, 0xff);
+  AssertIsTrue(!q.offerFromISR(bad, sizeof(bad)));
+  q.setHouseCode(10, 21);
+  AssertIsTrue(q.isEmpty());
+  AssertIsTrue(q.offerFromISR(buf, sizeof(buf)));
+  AssertIsTrue(q.offerFromISR(buf, sizeof(buf)));
+  AssertIsTrue(!q.offerFromISR(buf, sizeof(buf))); // Full.
+  AssertIsEqual(1, q.getDropped());
+  AssertIsEqual(2, q.getDepth());
+  OTProtocolCC::CC1PollAndCommand p2;
+  AssertIsTrue(q.take(p2));
+  AssertIsTrue(p2.isValid());
+  AssertIsEqual(50, p2.getRP());
+  AssertIsEqual(5, p2.getSeq());
+  AssertIsEqual(1, q.getDepth());
+  AssertIsTrue(q.offerFromISR(buf, sizeof(buf))); // Wraps round.
+  AssertIsEqual(2, q.getDepth());
+  AssertIsTrue(q.take(p2));
+  AssertIsTrue(q.take(p2));
+  AssertIsEqual(0, q.getDepth());
+  AssertIsTrue(!q.take(p2));
+  AssertIsTrue(q.isEmpty());
+  // Other frame types are not for the relay.
+  const OTProtocolCC::CC1Alert a = OTProtocolCC::CC1Alert::make(10, 21);
+  AssertIsEqual(8, a.encodeSimple(buf, sizeof(buf), true));
+  AssertIsTrue(!q.offerFromISR(buf, sizeof(buf)));
+  // Check that corrupting any single bit causes rejection by both the filter and the full decoder.
+  AssertIsEqual(8, p.encodeSimple(buf, sizeof(buf), true));
+  buf[OTV0P2BASE::randRNG8() & 7] ^= (1 << (OTV0P2BASE::randRNG8() & 7));
+  p2.decodeSimple(buf, sizeof(buf));
+  AssertIsTrue(!p2.isValid());
+  AssertIsTrue(!OTProtocolCC::CC1RelayRxFilter::isPollAndCommandFor(buf, sizeof(buf), 10, 21));
+  }
+
+// Do some basic testing of optional sequence numbers and link stats.
+static void testSeqAndLinkStats()
+  {
+  Serial.println("SeqAndLinkStats");
+  uint8_t buf[13]; // More than long enough.
+  // Legacy alert has no sequence number and unchanged wire form.
+  const OTProtocolCC::CC1Alert a0 = OTProtocolCC::CC1Alert::make(10, 21);
+  AssertIsTrue(!a0.hasSeq());
+  AssertIsEqual(8, a0.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(1, buf[4]);
+  AssertIsEqual(55, buf[7]);
+  // Sequence number is carried in the second extension byte and taken modulo 128.
+  const OTProtocolCC::CC1Alert a1 = OTProtocolCC::CC1Alert::make(10, 21, 130);
+  AssertIsTrue(a1.hasSeq());
+  AssertIsEqual(2, a1.getSeq());
+  AssertIsEqual(8, a1.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(1, buf[3]); // Still as legacy decoders expect.
+  AssertIsEqual(4, buf[4]);
+  OTProtocolCC::CC1Alert a2;
+  AssertIsEqual(8, a2.decodeSimple(buf, sizeof(buf)));
+  AssertIsTrue(a2.isValid());
+  AssertIsEqual(2, a2.getSeq());
+  // Poll/command carries its sequence number in the last extension byte.
+  const OTProtocolCC::CC1PollAndCommand p1 = OTProtocolCC::CC1PollAndCommand::make(10, 21, 1, 2, 3, 1, 127);
+  AssertIsEqual(8, p1.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(1, buf[5]);
+  AssertIsEqual(129, buf[6]);
+  OTProtocolCC::CC1PollAndCommand p2;
+  AssertIsEqual(8, p2.decodeSimple(buf, sizeof(buf)));
+  AssertIsEqual(127, p2.getSeq());
+  AssertIsTrue(!OTProtocolCC::CC1PollAndCommand::make(10, 21, 1, 2, 3, 1).hasSeq());
+  // Out-of-range sequence byte is rejected even with a good CRC.
+  buf[6] = 130;
+  buf[7] = OTProtocolCC::CC1Base::computeSimpleCRC(buf, sizeof(buf));
+  AssertIsEqual(0, p2.decodeSimple(buf, sizeof(buf)));
+  // Gaps, duplicates and restarts.
+  OTProtocolCC::CC1SeqStats s;
+  s.update(OTProtocolCC::CC1Base::no_seq);
+  AssertIsEqual(0, s.received);
+  s.update(126);
+  s.update(127);
+  s.update(127);
+  s.update(2); // Wraps, skipping 0 and 1.
+  AssertIsEqual(3, s.received);
+  AssertIsEqual(1, s.duplicates);
+  AssertIsEqual(2, s.lost);
+  AssertIsEqual(400, s.getLossPermille());
+  s.update(0); // Restart.
+  AssertIsEqual(1, s.resyncs);
+  AssertIsEqual(2, s.lost);
+  // Per-relay registry.
+  static OTProtocolCC::CC1LinkStatsRegistry<4> r;
+  r.clear();
+  AssertIsTrue(r.update(a2));
+  AssertIsTrue(r.update(10, 21, 4));
+  AssertIsTrue(!r.update(0xff, 21, 4));
+  AssertIsEqual(1, r.size());
+  AssertIsEqual(1, r.find(10, 21)->lost);
+  // Default instances carry no sequence number.
+  AssertIsTrue(!OTProtocolCC::CC1Alert().hasSeq());
+  AssertIsTrue(!OTProtocolCC::CC1PollAndCommand().hasSeq());
+  // Round-trip loss on the poll/response link.
+  typedef OTProtocolCC::CC1PollLinkStatsRegistry<4> PL;
+  static PL pl;
+  pl.clear();
+  const uint32_t t0 = 0xfffff000UL; // Clock about to wrap.
+  AssertIsEqual(0, pl.beginPoll(10, 21, t0));
+  AssertIsEqual(0, pl.find(10, 21)->getLossPermille()); // Still awaited.
+  AssertIsTrue(pl.onResponse(10, 21, t0 + 500));
+  AssertIsTrue(!pl.onResponse(10, 21, t0 + 600)); // Unsolicited.
+  // Unanswered poll: the next repeats its sequence number.
+  AssertIsEqual(1, pl.beginPoll(10, 21, t0 + 30000));
+  AssertIsEqual(1, pl.beginPoll(10, 21, t0 + 60000));
+  AssertIsTrue(pl.onResponse(10, 21, t0 + 60000 + PL::response_window_ms - 1));
+  // Late answer counts as lost but moves the sequence on.
+  AssertIsEqual(2, pl.beginPoll(10, 21, t0 + 90000));
+  AssertIsTrue(!pl.onResponse(OTProtocolCC::CC1PollResponse::make(10, 21, 30, 40, 80, 50, false, false, false), t0 + 90000 + PL::response_window_ms));
+  AssertIsEqual(3, pl.beginPoll(10, 21, t0 + 120000));
+  const OTProtocolCC::CC1PollLinkStats *const ps = pl.find(10, 21);
+  AssertIsEqual(5, ps->polls);
+  AssertIsEqual(2, ps->answered);
+  AssertIsEqual(500, ps->getLossPermille()); // 2 of 4 completed polls lost.
+  AssertIsEqual(OTProtocolCC::CC1Base::no_seq, pl.beginPoll(0xff, 21, t0));
+  AssertIsTrue(!pl.onResponse(11, 21, t0));
+  AssertIsEqual(1, pl.size());
+  }
+
+// Do some basic testing of the CC1 group command object.
+static void testCC1GroupCommand()
+  {
+  Serial.println("CC1GroupCommand");
+  OTProtocolCC::CC1GroupCommand g0;
+  AssertIsTrue(!g0.isValid());
+  // Default instance starts with no members.
+  AssertIsTrue(g0.addMember(3));
+  AssertIsTrue(g0.isMember(3));
+  AssertIsTrue(!g0.isMember(4));
+  // No members yet, so not valid or encodable.
+  OTProtocolCC::CC1GroupCommand g = OTProtocolCC::CC1GroupCommand::make(7, 0, 0, 1, 1);
+  AssertIsTrue(!g.isValid());
+  uint8_t buf[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1GroupCommand::max_frame_bytes>::total];
+  AssertIsEqual(0, g.encodeSimple(buf, sizeof(buf), true));
+  AssertIsTrue(!g.addMember(64));
+  AssertIsTrue(g.addMember(0));
+  AssertIsTrue(g.addMember(9));
+  AssertIsTrue(g.isValid());
+  AssertIsTrue(g.isMember(9));
+  AssertIsTrue(!g.isMember(8));
+  AssertIsEqual(7, g.getGroupID());
+  // Up to 16 members fits in 7 bytes with CRC7.
+  AssertIsEqual(8, g.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual('%', buf[0]); // FTp2_CC1GroupCmd.
+  AssertIsEqual(7,   buf[1]);
+  AssertIsEqual(2,   buf[2]);
+  AssertIsEqual(1,   buf[3]);
+  AssertIsEqual((1 << 6) | (1 << 2) | (0), buf[4]);
+  AssertIsEqual(1,   buf[5]);
+  AssertIsEqual(2,   buf[6]);
+  // Relay-side quick membership test before CRC.
+  const OTProtocolCC::CC1GroupMembership mem9(7, 9);
+  const OTProtocolCC::CC1GroupMembership mem8(7, 8);
+  const OTProtocolCC::CC1GroupMembership other(6, 9);
+  const OTProtocolCC::CC1GroupMembership far(7, 63);
+  AssertIsTrue(mem9.matchesFrame(buf, sizeof(buf)));
+  AssertIsTrue(!mem9.matchesFrame(buf, 6));
+  AssertIsTrue(!mem8.matchesFrame(buf, sizeof(buf)));
+  AssertIsTrue(!other.matchesFrame(buf, sizeof(buf)));
+  AssertIsTrue(!far.matchesFrame(buf, sizeof(buf)));
+  AssertIsTrue(!OTProtocolCC::CC1GroupMembership(7, 64).isValid());
+  // Full decode, then apply as an individual command.
+  OTProtocolCC::CC1GroupCommand g2;
+  AssertIsEqual(8, g2.decodeSimple(buf, sizeof(buf)));
+  AssertIsTrue(g2.isValid());
+  AssertIsTrue(mem9.matches(g2));
+  AssertIsTrue(!mem8.matches(g2));
+  const OTProtocolCC::CC1PollAndCommand p = g2.getCommandFor(10, 21);
+  AssertIsTrue(p.isValid());
+  AssertIsEqual(10, p.getHC1());
+  AssertIsEqual(0, p.getRP());
+  AssertIsEqual(0, p.getLC());
+  AssertIsEqual(1, p.getLT());
+  AssertIsEqual(1, p.getLF());
+  // Larger groups use the longer CRC.
+  AssertIsTrue(g.addMember(63));
+  AssertIsEqual(15, g.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(15, g2.decodeSimple(buf, sizeof(buf)));
+  AssertIsTrue(far.matches(g2));
+  AssertIsTrue(far.matchesFrame(buf, sizeof(buf)));
+  // Check that corrupting any single bit causes message rejection.
+  buf[OTV0P2BASE::randRNG8() % 15] ^= (1 << (OTV0P2BASE::randRNG8() & 7));
+  g2.decodeSimple(buf, sizeof(buf));
+  AssertIsTrue(!g2.isValid());
+  }
+
+// Do some basic testing of length-aware framing and CRC selection.
+static void testFraming()
+  {
+  Serial.println("Framing");
+  // Compile-time sizes for the fixed-length types.
+  AssertIsEqual(8, OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1Alert::primary_frame_bytes>::total);
+  AssertIsEqual(1, OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1PollResponse::primary_frame_bytes>::crc);
+  AssertIsEqual(2, OTProtocolCC::CC1FrameBytes<8>::crc);
+  AssertIsEqual(1, OTProtocolCC::CC1Base::crcBytesForLength(7));
+  AssertIsEqual(2, OTProtocolCC::CC1Base::crcBytesForLength(8));
+  // Long CRC matches the standard check value (as CRC-16/MCRF4XX) without avr-libc.
+  const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+  AssertIsEqual(0x6f91, OTProtocolCC::CC1Base::computeLongCRC(check, sizeof(check), sizeof(check)));
+  // Short frames get exactly the CRC7 used by the fixed-length messages.
+  uint8_t buf[13]; // More than long enough.
+  const uint8_t bufAlert1[] = {'!', 10, 21, 1, 1, 1, 1};
+  memcpy(buf, bufAlert1, sizeof(bufAlert1));
+  AssertIsEqual(0, OTProtocolCC::CC1Base::appendFrameCRC(buf, 7, 7));
+  AssertIsEqual(8, OTProtocolCC::CC1Base::appendFrameCRC(buf, sizeof(buf), 7));
+  AssertIsEqual(55, buf[7]);
+  AssertIsTrue(OTProtocolCC::CC1Base::checkFrameCRC(buf, sizeof(buf), 7));
+  AssertIsEqual(OTProtocolCC::CC1Base::computeSimpleCRC(buf, sizeof(buf)), OTProtocolCC::CC1Base::computeCRC7(buf, sizeof(buf), 7));
+  // Longer frames get a 16-bit CRC.
+  for(uint8_t i = 7; i < 10; ++i) { buf[i] = i; }
+  AssertIsEqual(12, OTProtocolCC::CC1Base::appendFrameCRC(buf, sizeof(buf), 10));
+  AssertIsTrue(OTProtocolCC::CC1Base::checkFrameCRC(buf, sizeof(buf), 10));
+  AssertIsTrue(!OTProtocolCC::CC1Base::checkFrameCRC(buf, 11, 10));
+  buf[OTV0P2BASE::randRNG8() % 12] ^= (1 << (OTV0P2BASE::randRNG8() & 7));
+  AssertIsTrue(!OTProtocolCC::CC1Base::checkFrameCRC(buf, sizeof(buf), 10));
+  // Frame length can be found from the start of the frame.
+  buf[0] = '?';
+  AssertIsEqual(7, OTProtocolCC::CC1Base::getFrameLength(buf, 1));
+  buf[0] = 'z';
+  AssertIsEqual(0, OTProtocolCC::CC1Base::getFrameLength(buf, sizeof(buf)));
+  buf[0] = '&';
+  buf[1] = 3;
+  AssertIsEqual(0, OTProtocolCC::CC1Base::getFrameLength(buf, 1));
+  AssertIsEqual(14, OTProtocolCC::CC1Base::getFrameLength(buf, 2));
+  buf[1] = 0;
+  AssertIsEqual(0, OTProtocolCC::CC1Base::getFrameLength(buf, 2));
+  buf[0] = '+';
+  buf[3] = (3 << 4) | 5;
+  AssertIsEqual(6, OTProtocolCC::CC1Base::getFrameLength(buf, 4));
+  // A single-entry aggregated frame is short enough for CRC7.
+  OTProtocolCC::CC1MultiPollAndCommand m;
+  AssertIsTrue(m.add(OTProtocolCC::CC1PollAndCommand::make(10, 21, 1, 2, 3, 1)));
+  AssertIsEqual(7, m.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(6, OTProtocolCC::CC1Base::getFrameLength(buf, 2));
+  OTProtocolCC::CC1MultiPollAndCommand m2;
+  AssertIsEqual(7, m2.decodeSimple(buf, 7));
+  AssertIsEqual(1, m2.getCount());
+  }
+
+// Do some basic testing of the compact (delta) Poll-Response form.
+static void testCC1PRDelta()
+  {
+  Serial.println("CC1PRDelta");
+  const OTProtocolCC::CC1PollResponse base = OTProtocolCC::CC1PollResponse::make(10, 21, 45, 160, 101, 35, true, false, false);
+  // Only tr has changed.
+  const OTProtocolCC::CC1PollResponse cur = OTProtocolCC::CC1PollResponse::make(10, 21, 45, 160, 103, 35, true, false, false);
+  const uint8_t tag = OTProtocolCC::CC1PollResponseDelta::getTag(base);
+  AssertIsTrue((tag >= 1) && (tag <= 14));
+  uint8_t buf[13]; // More than long enough.
+  AssertIsEqual(0, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, cur, buf, 5, true));
+  AssertIsEqual(6, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, cur, buf, sizeof(buf), true));
+  AssertIsEqual('+', buf[0]); // FTp2_CC1PollResponseDelta.
+  AssertIsEqual(10,  buf[1]);
+  AssertIsEqual(21,  buf[2]);
+  AssertIsEqual((tag << 4) | 4, buf[3]);
+  AssertIsEqual(104, buf[4]);
+  // Decode against the correct base.
+  OTProtocolCC::CC1PollResponse out;
+  AssertIsEqual(6, OTProtocolCC::CC1PollResponseDelta::decodeSimple(buf, sizeof(buf), base, out));
+  AssertIsTrue(out.isValid());
+  AssertIsEqual(10, out.getHC1());
+  AssertIsEqual(21, out.getHC2());
+  AssertIsEqual(45, out.getRH());
+  AssertIsEqual(160, out.getTP());
+  AssertIsEqual(103, out.getTR());
+  AssertIsEqual(35, out.getAL());
+  AssertIsEqual(true, out.getS());
+  // Decoding against the wrong base must fail.
+  const OTProtocolCC::CC1PollResponse other = OTProtocolCC::CC1PollResponse::make(10, 21, 45, 160, 101, 36, true, false, false);
+  AssertIsEqual(0, OTProtocolCC::CC1PollResponseDelta::decodeSimple(buf, sizeof(buf), other, out));
+  AssertIsTrue(!out.isValid());
+  // No change gives the minimum frame.
+  AssertIsEqual(5, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, base, buf, sizeof(buf), true));
+  // Too many changes or a different relay must be sent in full.
+  const OTProtocolCC::CC1PollResponse big = OTProtocolCC::CC1PollResponse::make(10, 21, 40, 150, 100, 30, true, false, false);
+  AssertIsEqual(0, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, big, buf, sizeof(buf), true));
+  const OTProtocolCC::CC1PollResponse moved = OTProtocolCC::CC1PollResponse::make(11, 21, 45, 160, 101, 35, true, false, false);
+  AssertIsEqual(0, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, moved, buf, sizeof(buf), true));
+  // Relay-side encoder sends full, then compact against the last acknowledged response, with periodic full refresh.
+  OTProtocolCC::CC1PollResponseDeltaEncoder e;
+  static OTProtocolCC::CC1PollResponseRegistry<4> reg;
+  reg.clear();
+  // Legacy polls without sequence numbers acknowledge nothing, so every response is full.
+  const OTProtocolCC::CC1PollAndCommand legacy = OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1);
+  e.onPoll(legacy);
+  AssertIsEqual(8, e.encode(base, buf, sizeof(buf)));
+  e.onPoll(legacy);
+  AssertIsEqual(8, e.encode(cur, buf, sizeof(buf)));
+  AssertIsTrue(!e.isAcknowledged());
+  e.reset();
+  // The hub's next poll, with a new sequence number, acknowledges the response.
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 0));
+  AssertIsEqual(8, e.encode(base, buf, sizeof(buf)));
+  AssertIsEqual(8, reg.decode(buf, sizeof(buf), out));
+  AssertIsEqual(1, reg.size());
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 1));
+  AssertIsTrue(e.isAcknowledged());
+  AssertIsEqual(6, e.encode(cur, buf, sizeof(buf)));
+  AssertIsEqual(6, reg.decode(buf, sizeof(buf), out));
+  AssertIsEqual(103, out.getTR());
+  // A lost response is not used as the base:
+  // the hub repeats the sequence number and the next delta is still against what it holds.
+  const OTProtocolCC::CC1PollResponse cur2 = OTProtocolCC::CC1PollResponse::make(10, 21, 45, 160, 104, 35, true, false, false);
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 2));
+  AssertIsEqual(6, e.encode(cur2, buf, sizeof(buf))); // Lost.
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 2));
+  AssertIsTrue(!e.isAcknowledged());
+  AssertIsEqual(6, e.encode(cur2, buf, sizeof(buf)));
+  AssertIsEqual(6, reg.decode(buf, sizeof(buf), out));
+  AssertIsEqual(104, out.getTR());
+  // Full refresh after full_refresh_interval responses.
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 3));
+  AssertIsEqual(8, e.encode(cur2, buf, sizeof(buf)));
+  AssertIsEqual(8, reg.decode(buf, sizeof(buf), out));
+  // Hub registry rejects compact frames with no base.
+  reg.clear();
+  e.onPoll(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1, 4));
+  AssertIsEqual(5, e.encode(cur2, buf, sizeof(buf)));
+  AssertIsEqual(0, reg.decode(buf, sizeof(buf), out));
+  AssertIsTrue(!out.isValid());
+  // Check that corrupting any single bit causes message rejection.
+  AssertIsEqual(6, OTProtocolCC::CC1PollResponseDelta::encodeSimple(base, cur, buf, sizeof(buf), true));
+  buf[OTV0P2BASE::randRNG8() % 6] ^= (1 << (OTV0P2BASE::randRNG8() & 7));
+  OTProtocolCC::CC1PollResponseDelta::decodeSimple(buf, sizeof(buf), base, out);
+  AssertIsTrue(!out.isValid());
+  }
+
+// Do some basic testing of the CC1 aggregated Poll-and-Command object.
+static void testCC1MultiPAC()
+  {
+  Serial.println("CC1MultiPAC");
+  OTProtocolCC::CC1MultiPollAndCommand m;
+  // Bare instance should be invalid by default and not encodable.
+  AssertIsTrue(!m.isValid());
+  uint8_t buf[OTProtocolCC::CC1FrameBytes<OTProtocolCC::CC1MultiPollAndCommand::max_frame_bytes>::total];
+  AssertIsEqual(0, m.encodeSimple(buf, sizeof(buf), true));
+  // Invalid commands and duplicate relays are refused.
+  AssertIsTrue(!m.add(OTProtocolCC::CC1PollAndCommand::make(0xff, 0, 0, 0, 0, 0)));
+  AssertIsTrue(m.add(OTProtocolCC::CC1PollAndCommand::make(10, 21, 1, 2, 3, 1)));
+  AssertIsTrue(!m.add(OTProtocolCC::CC1PollAndCommand::make(10, 21, 50, 2, 3, 1)));
+  AssertIsTrue(m.add(OTProtocolCC::CC1PollAndCommand::make(99, 0, 100, 0, 15, 3)));
+  AssertIsTrue(m.isValid());
+  AssertIsEqual(2, m.getCount());
+  AssertIsEqual(10, m.getFrameBytes());
+  // Encode; each entry uses the CC1PollAndCommand packing.
+  AssertIsEqual(0, m.encodeSimple(buf, 11, true));
+  AssertIsEqual(10, m.encodeSimple(buf, sizeof(buf), false));
+  AssertIsEqual(12, m.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual('&', buf[0]);
+  AssertIsEqual(2,   buf[1]);
+  AssertIsEqual(10,  buf[2]);
+  AssertIsEqual(21,  buf[3]);
+  AssertIsEqual(2,   buf[4]);
+  AssertIsEqual((1 << 6) | (3 << 2) | (2), buf[5]);
+  AssertIsEqual(99,  buf[6]);
+  AssertIsEqual(0,   buf[7]);
+  AssertIsEqual(101, buf[8]);
+  AssertIsEqual((3 << 6) | (15 << 2) | (0), buf[9]);
+  // Decode and find own entry as a relay would.
+  OTProtocolCC::CC1MultiPollAndCommand m2;
+  AssertIsEqual(0, m2.decodeSimple(buf, 11));
+  AssertIsEqual(12, m2.decodeSimple(buf, sizeof(buf)));
+  AssertIsTrue(m2.isValid());
+  AssertIsEqual(2, m2.getCount());
+  const OTProtocolCC::CC1PollAndCommand p = m2.find(99, 0);
+  AssertIsTrue(p.isValid());
+  AssertIsEqual(100, p.getRP());
+  AssertIsEqual(0, p.getLC());
+  AssertIsEqual(15, p.getLT());
+  AssertIsEqual(3, p.getLF());
+  AssertIsTrue(!m2.find(10, 22).isValid());
+  AssertIsTrue(!m2.get(2).isValid());
+  AssertIsEqual(21, m2.get(0).getHC2());
+  // Fill to capacity.
+  for(uint8_t i = 2; i < OTProtocolCC::CC1MultiPollAndCommand::max_entries; ++i)
+    { AssertIsTrue(m.add(OTProtocolCC::CC1PollAndCommand::make(i, i, i, 1, 1, 1))); }
+  AssertIsTrue(!m.add(OTProtocolCC::CC1PollAndCommand::make(50, 50, 0, 1, 1, 1)));
+  AssertIsEqual(sizeof(buf), m.encodeSimple(buf, sizeof(buf), true));
+  AssertIsEqual(sizeof(buf), m2.decodeSimple(buf, sizeof(buf)));
+  // Check that corrupting any single bit causes message rejection.
+  buf[OTV0P2BASE::randRNG8() % sizeof(buf)] ^= (1 << (OTV0P2BASE::randRNG8() & 7));
+  m2.decodeSimple(buf, sizeof(buf));
+  AssertIsTrue(!m2.isValid());
+  }
+
+// Do some basic testing of the house-code-keyed registry.
+static void testHouseCodeMap()
+  {
+  Serial.println("HouseCodeMap");
+  static OTProtocolCC::CC1HouseCodeMap<uint8_t, 4> m;
+  m.clear();
+  AssertIsEqual(0, m.size());
+  AssertIsTrue(NULL == m.find(10, 21));
+  // Invalid house codes are never stored.
+  AssertIsTrue(NULL == m.findOrInsert(0xff, 21));
+  uint8_t *const v1 = m.findOrInsert(10, 21);
+  AssertIsTrue(NULL != v1);
+  *v1 = 42;
+  AssertIsEqual(1, m.size());
+  AssertIsEqual(42, *m.find(10, 21));
+  // Re-inserting finds the existing entry.
+  AssertIsTrue(v1 == m.findOrInsert(10, 21));
+  AssertIsEqual(1, m.size());
+  // Fill to capacity; one more must fail.
+  AssertIsTrue(NULL != m.findOrInsert(99, 99));
+  AssertIsTrue(NULL != m.findOrInsert(0, 0));
+  AssertIsTrue(NULL != m.findOrInsert(21, 10));
+  AssertIsEqual(4, m.size());
+  AssertIsTrue(NULL == m.findOrInsert(1, 1));
+  AssertIsTrue(NULL == m.find(1, 1));
+  AssertIsEqual(42, *m.find(10, 21));
+  m.clear();
+  AssertIsEqual(0, m.size());
+  AssertIsTrue(NULL == m.find(10, 21));
+  }
+
+// Do some basic testing of replay protection.
+static void testReplayProtection()
+  {
+  Serial.println("ReplayProtection");
+  OTProtocolCC::CC1ReplayWindow w;
+  // Fresh window accepts anything once.
+  AssertIsTrue(w.isFresh(0));
+  AssertIsTrue(w.checkAndSet(0));
+  AssertIsTrue(!w.checkAndSet(0));
+  AssertIsTrue(w.checkAndSet(5));
+  AssertIsEqual(5, (int)w.getHighest());
+  // Out-of-order within window is accepted once.
+  AssertIsTrue(w.isFresh(3));
+  AssertIsTrue(w.checkAndSet(3));
+  AssertIsTrue(!w.isFresh(3));
+  AssertIsTrue(!w.checkAndSet(3));
+  AssertIsTrue(!w.checkAndSet(5));
+  // Just inside and just outside the window.
+  AssertIsTrue(w.checkAndSet(100));
+  AssertIsTrue(w.checkAndSet(100 - 63));
+  AssertIsTrue(!w.checkAndSet(100 - 64));
+  // Large jump clears the history.
+  AssertIsTrue(w.checkAndSet(100000));
+  AssertIsTrue(w.checkAndSet(99999));
+  AssertIsTrue(!w.checkAndSet(100));
+  // Registry keeps independent windows per relay.
+  static OTProtocolCC::CC1ReplayRegistry<4> r;
+  r.clear();
+  AssertIsTrue(r.checkAndSet(10, 21, 7));
+  AssertIsTrue(r.checkAndSet(11, 21, 7));
+  AssertIsTrue(!r.checkAndSet(10, 21, 7));
+  AssertIsTrue(!r.checkAndSet(0xff, 0xff, 8));
+  AssertIsEqual(2, r.size());
+  // Relay-side counter persists once per epoch and never reuses values across restarts.
+  OTProtocolCC::CC1TxCounter c;
+  c.restore(0);
+  AssertIsTrue(c.needsPersist());
+  AssertIsEqual(1, c.getEpochToPersist());
+  c.epochPersisted();
+  uint8_t writes = 1;
+  uint32_t last = 0;
+  for(uint16_t i = 0; i < 600; ++i)
+    {
+    if(c.needsPersist()) { c.epochPersisted(); ++writes; }
+    AssertIsTrue(!c.isExhausted());
+    last = c.take();
+    }
+  AssertIsEqual(599, (int)last);
+  AssertIsEqual(3, writes);
+  // Simulate restart from the last persisted epoch.
+  OTProtocolCC::CC1TxCounter c2;
+  c2.restore(3);
+  AssertIsTrue(c2.needsPersist());
+  c2.epochPersisted();
+  AssertIsTrue(c2.take() > last);
+  }
+
+
 
 
 
@@ -289,6 +1793,31 @@ void loop()
   testLibVersion();
   testLibVersions();
 
+  testAirtime();
+  testPollInterval();
+  testDecodeCache();
+  testCRC7Kernel();
+  testVerifyCRCBatch();
+  testMessageTemplate();
+  testCommandDiffer();
+  testRelayTxScheduler();
+  testSnapshot();
+  testRelayAcceptance();
+  testMetrics();
+  testLatency();
+  testTrace();
+  testUnits();
+  testEncodedFrame();
+  testMessagePool();
+  testRelayRx();
+  testSeqAndLinkStats();
+  testCC1GroupCommand();
+  testFraming();
+  testCC1PRDelta();
+  testCC1MultiPAC();
+  testReplayProtection();
+  testHouseCodeMap();
+
   testCommonCRC();
   testCC1Alert();
   testCC1PAC();